@@ -0,0 +1,379 @@
+#include <cparse/asyncclient.h>
+#include <cparse/exception.h>
+#include "client.h"
+#include <curl/curl.h>
+#include <algorithm>
+
+namespace cparse
+{
+    // the most handles kept for reuse, the rest are cleaned up when their request finishes
+    static const size_t MAX_IDLE_HANDLES = 32;
+
+#if LIBCURL_VERSION_NUM < 0x074400
+    // how long the reactor waits for activity when curl can't be woken up
+    static const int POLL_TIMEOUT_MS = 10;
+#endif
+
+    struct AsyncClient::Transfer
+    {
+        CURL *curl;
+        struct curl_slist *headers;
+        http::method method;
+        string url;
+        string payload;
+        Response response;
+        ResponseCallback callback;
+    };
+
+    static size_t async_append_response_callback(char *ptr, size_t size, size_t nmemb, void *param)
+    {
+        string *response = static_cast<string *>(param);
+
+        response->append(ptr, size * nmemb);
+
+        return size * nmemb;
+    }
+
+    JSON Response::json() const
+    {
+        JSON obj;
+
+        if (!obj.parse(body))
+            throw Exception("reponse is not a valid response");
+
+        if (obj.contains("error"))
+        {
+            throw Exception(obj.get_string("error"));
+        }
+
+        return obj;
+    }
+
+    AsyncClient &AsyncClient::shared()
+    {
+        static AsyncClient client;
+
+        return client;
+    }
+
+    AsyncClient::AsyncClient() : multi_(NULL), stopping_(false)
+    {
+        curl_global_init(CURL_GLOBAL_ALL);
+
+        multi_ = curl_multi_init();
+
+        if (multi_ == NULL)
+        {
+            throw Exception("unable to initialize async client");
+        }
+
+        reactor_ = std::thread(&AsyncClient::run, this);
+    }
+
+    AsyncClient::~AsyncClient()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            stopping_ = true;
+        }
+
+        wakeup();
+
+        reactor_.join();
+
+        for (auto curl : idle_)
+        {
+            curl_easy_cleanup(static_cast<CURL *>(curl));
+        }
+
+        curl_multi_cleanup(static_cast<CURLM *>(multi_));
+
+        curl_global_cleanup();
+    }
+
+    bool AsyncClient::inReactor() const
+    {
+        return std::this_thread::get_id() == reactor_.get_id();
+    }
+
+    void AsyncClient::wakeup()
+    {
+#if LIBCURL_VERSION_NUM >= 0x074400
+        curl_multi_wakeup(static_cast<CURLM *>(multi_));
+#endif
+    }
+
+    void AsyncClient::send(http::method method, const string &path, const string &payload, ResponseCallback callback, const Headers &headers)
+    {
+        Transfer *transfer = new Transfer();
+        shared_ptr<const Headers> defaults = Client::defaultHeaders();
+        string line;
+
+        transfer->curl = NULL;
+        transfer->headers = NULL;
+        transfer->method = method;
+        transfer->url = Client::buildUrl(path);
+        transfer->payload = payload;
+        transfer->response.code = 0;
+        transfer->callback = std::move(callback);
+
+        // the given headers replace the defaults with the same name
+        for (auto &h : *defaults)
+        {
+            if (headers.find(h.first) == headers.end())
+            {
+                line.assign(h.first).append(": ").append(h.second);
+
+                transfer->headers = curl_slist_append(transfer->headers, line.c_str());
+            }
+        }
+
+        for (auto &h : headers)
+        {
+            line.assign(h.first).append(": ").append(h.second);
+
+            transfer->headers = curl_slist_append(transfer->headers, line.c_str());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            if (stopping_)
+            {
+                curl_slist_free_all(transfer->headers);
+
+                delete transfer;
+
+                throw Exception("async client is stopping");
+            }
+
+            pending_.push_back(transfer);
+        }
+
+        wakeup();
+    }
+
+    Awaitable<Response> AsyncClient::request(http::method method, const string &path, const string &payload, const Headers &headers)
+    {
+        return Awaitable<Response>([this, method, &path, &payload, &headers](Awaitable<Response>::Callback done)
+        {
+            send(method, path, payload, [done](const Response & response, std::exception_ptr error)
+            {
+                done(response, error);
+            }, headers);
+        });
+    }
+
+    Awaitable<Response> AsyncClient::get(const string &path)
+    {
+        return request(http::GET, path);
+    }
+
+    Awaitable<Response> AsyncClient::post(const string &path, const string &payload)
+    {
+        return request(http::POST, path, payload);
+    }
+
+    Awaitable<Response> AsyncClient::put(const string &path, const string &payload)
+    {
+        return request(http::PUT, path, payload);
+    }
+
+    Awaitable<Response> AsyncClient::de1ete(const string &path)
+    {
+        return request(http::DELETE, path);
+    }
+
+    void AsyncClient::start(Transfer *transfer)
+    {
+        CURL *curl = NULL;
+
+        if (!idle_.empty())
+        {
+            curl = static_cast<CURL *>(idle_.back());
+
+            idle_.pop_back();
+        }
+        else
+        {
+            curl = curl_easy_init();
+        }
+
+        if (curl == NULL)
+        {
+            finish(transfer, CURLE_FAILED_INIT);
+            return;
+        }
+
+        transfer->curl = curl;
+
+        curl_easy_setopt(curl, CURLOPT_URL, transfer->url.c_str());
+
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+
+        curl_easy_setopt(curl, CURLOPT_PRIVATE, transfer);
+
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, async_append_response_callback);
+
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer->response.body);
+
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer->headers);
+
+        switch (transfer->method)
+        {
+        case http::GET:
+            curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+            break;
+        case http::POST:
+            curl_easy_setopt(curl, CURLOPT_POST, 1L);
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, transfer->payload.c_str());
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, transfer->payload.size());
+            break;
+        case http::PUT:
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, transfer->payload.c_str());
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, transfer->payload.size());
+            break;
+        case http::DELETE:
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+            break;
+        }
+
+        if (curl_multi_add_handle(static_cast<CURLM *>(multi_), curl) != CURLM_OK)
+        {
+            finish(transfer, CURLE_FAILED_INIT);
+            return;
+        }
+
+        active_.push_back(transfer);
+    }
+
+    void AsyncClient::finish(Transfer *transfer, int result)
+    {
+        std::exception_ptr error;
+
+        if (transfer->curl != NULL)
+        {
+            long code = 0;
+
+            curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &code);
+
+            transfer->response.code = code;
+
+            curl_multi_remove_handle(static_cast<CURLM *>(multi_), transfer->curl);
+
+            auto it = std::find(active_.begin(), active_.end(), transfer);
+
+            if (it != active_.end())
+            {
+                *it = active_.back();
+                active_.pop_back();
+            }
+
+            // keeps the connection for the next request
+            curl_easy_reset(transfer->curl);
+
+            if (idle_.size() < MAX_IDLE_HANDLES)
+            {
+                idle_.push_back(transfer->curl);
+            }
+            else
+            {
+                curl_easy_cleanup(transfer->curl);
+            }
+        }
+
+        if (result != CURLE_OK)
+        {
+            error = std::make_exception_ptr(Exception(curl_easy_strerror(static_cast<CURLcode>(result))));
+        }
+
+        try
+        {
+            transfer->callback(transfer->response, error);
+        }
+        catch (...)
+        {
+            // nothing can handle it on the reactor thread
+        }
+
+        curl_slist_free_all(transfer->headers);
+
+        delete transfer;
+    }
+
+    void AsyncClient::run()
+    {
+        CURLM *multi = static_cast<CURLM *>(multi_);
+        int running = 0;
+
+        for (;;)
+        {
+            std::deque<Transfer *> pending;
+            bool stopping = false;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+
+                pending.swap(pending_);
+
+                stopping = stopping_;
+            }
+
+            if (stopping)
+            {
+                break;
+            }
+
+            for (auto transfer : pending)
+            {
+                start(transfer);
+            }
+
+            curl_multi_perform(multi, &running);
+
+            CURLMsg *msg = NULL;
+            int remaining = 0;
+
+            while ((msg = curl_multi_info_read(multi, &remaining)) != NULL)
+            {
+                if (msg->msg == CURLMSG_DONE)
+                {
+                    Transfer *transfer = NULL;
+
+                    curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &transfer);
+
+                    finish(transfer, msg->data.result);
+                }
+            }
+
+#if LIBCURL_VERSION_NUM >= 0x074400
+            curl_multi_poll(multi, NULL, 0, 1000, NULL);
+#else
+            curl_multi_wait(multi, NULL, 0, POLL_TIMEOUT_MS, NULL);
+#endif
+        }
+
+        // fail what was never finished
+        std::deque<Transfer *> pending;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            pending.swap(pending_);
+        }
+
+        for (auto transfer : pending)
+        {
+            finish(transfer, CURLE_ABORTED_BY_CALLBACK);
+        }
+
+        while (!active_.empty())
+        {
+            finish(active_.back(), CURLE_ABORTED_BY_CALLBACK);
+        }
+    }
+}
@@ -4,7 +4,13 @@
 #include <cparse/user.h>
 #include <cparse/parse.h>
 #include <cparse/clientinterface.h>
+#include <cparse/asyncclient.h>
 #include <curl/curl.h>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+#include <algorithm>
+#include <unistd.h>
 
 namespace cparse
 {
@@ -13,30 +19,524 @@ namespace cparse
     extern string cparse_api_key_;
     extern ClientInterface *cparse_client_interface_;
 
-    static size_t curl_append_response_callback(void *ptr, size_t size, size_t nmemb, string *s)
+    // the most a response is reserved from its content length, larger ones grow as they arrive
+    static const size_t MAX_RESERVE = 16 * 1024 * 1024;
+
+    // the smallest part worth its own connection in a ranged download
+    static const size_t MIN_RANGE_SIZE = 1024 * 1024;
+
+    // how long a ranged download waits for activity before checking again
+    static const int RANGE_WAIT_MS = 1000;
+
+    struct curl_transfer
+    {
+        const char *data;
+        size_t length;
+        const RequestSource *source;
+        ssize_t size;
+        string *response;
+        const ResponseSink *sink;
+        const ProgressCallback *progress;
+        size_t received;
+        size_t total;
+        const char *aborted;
+    };
+
+    static size_t curl_append_response_callback(char *ptr, size_t size, size_t nmemb, void *param)
+    {
+        curl_transfer *transfer = static_cast<curl_transfer *>(param);
+
+        const size_t len = size * nmemb;
+
+        if (transfer == NULL) return 0;
+
+        if (transfer->sink != NULL)
+        {
+            try
+            {
+                if (!(*transfer->sink)(ptr, len))
+                {
+                    transfer->aborted = "response aborted";
+                    return 0;
+                }
+
+                transfer->received += len;
+
+                if (transfer->progress != NULL && *transfer->progress)
+                {
+                    (*transfer->progress)(transfer->received, transfer->total);
+                }
+            }
+            catch (...)
+            {
+                // exceptions can't pass through curl
+                transfer->aborted = "response aborted";
+                return 0;
+            }
+        }
+        else
+        {
+            transfer->response->append(ptr, len);
+        }
+
+        return len;
+    }
+
+    static size_t curl_read_request_callback(char *buffer, size_t size, size_t nitems, void *param)
+    {
+        curl_transfer *transfer = static_cast<curl_transfer *>(param);
+
+        if (transfer == NULL) return CURL_READFUNC_ABORT;
+
+        try
+        {
+            return (*transfer->source)(buffer, size * nitems);
+        }
+        catch (...)
+        {
+            transfer->aborted = "request aborted";
+            return CURL_READFUNC_ABORT;
+        }
+    }
+
+    static size_t curl_response_header_callback(char *ptr, size_t size, size_t nmemb, void *param)
+    {
+        static const char CONTENT_LENGTH[] = "content-length:";
+
+        curl_transfer *transfer = static_cast<curl_transfer *>(param);
+
+        const size_t len = size * nmemb;
+
+        if (transfer != NULL && len > sizeof(CONTENT_LENGTH) - 1 && !strncasecmp(ptr, CONTENT_LENGTH, sizeof(CONTENT_LENGTH) - 1))
+        {
+            string value(ptr + sizeof(CONTENT_LENGTH) - 1, len - (sizeof(CONTENT_LENGTH) - 1));
+
+            unsigned long long length = strtoull(value.c_str(), NULL, 10);
+
+            transfer->total = length;
+
+            if (transfer->response != NULL && length > 0 && length <= MAX_RESERVE)
+            {
+                transfer->response->reserve(transfer->response->size() + length);
+            }
+        }
+
+        return len;
+    }
+
+    // what a HEAD request says about a download
+    struct curl_head
+    {
+        size_t length;
+        bool ranges;
+    };
+
+    static size_t curl_head_header_callback(char *ptr, size_t size, size_t nmemb, void *param)
+    {
+        static const char CONTENT_LENGTH[] = "content-length:";
+        static const char ACCEPT_RANGES[] = "accept-ranges:";
+
+        curl_head *head = static_cast<curl_head *>(param);
+
+        const size_t len = size * nmemb;
+
+        string line(ptr, len);
+
+        if (!strncasecmp(line.c_str(), CONTENT_LENGTH, sizeof(CONTENT_LENGTH) - 1))
+        {
+            head->length = strtoull(line.c_str() + sizeof(CONTENT_LENGTH) - 1, NULL, 10);
+        }
+        else if (!strncasecmp(line.c_str(), ACCEPT_RANGES, sizeof(ACCEPT_RANGES) - 1))
+        {
+            head->ranges = strcasestr(line.c_str() + sizeof(ACCEPT_RANGES) - 1, "bytes") != NULL;
+        }
+
+        return len;
+    }
+
+    // one part of a ranged download, written at its offset in the file
+    struct curl_range
+    {
+        CURL *curl;
+        int fd;
+        size_t offset;
+        size_t length;
+        size_t written;
+        size_t *received;
+        size_t total;
+        const ProgressCallback *progress;
+        bool failed;
+        bool ignored;
+    };
+
+    static size_t curl_write_range_callback(char *ptr, size_t size, size_t nmemb, void *param)
+    {
+        curl_range *range = static_cast<curl_range *>(param);
+
+        const size_t len = size * nmemb;
+
+        long code = 0;
+
+        // a server ignoring the range sends the whole file
+        curl_easy_getinfo(range->curl, CURLINFO_RESPONSE_CODE, &code);
+
+        if (code != 206)
+        {
+            range->ignored = true;
+            return 0;
+        }
+
+        if (range->written + len > range->length)
+        {
+            range->failed = true;
+            return 0;
+        }
+
+        for (size_t done = 0; done < len;)
+        {
+            ssize_t count = pwrite(range->fd, ptr + done, len - done, range->offset + range->written + done);
+
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+
+            if (count <= 0)
+            {
+                range->failed = true;
+                return 0;
+            }
+
+            done += count;
+        }
+
+        range->written += len;
+
+        *range->received += len;
+
+        if (*range->progress)
+        {
+            try
+            {
+                (*range->progress)(*range->received, range->total);
+            }
+            catch (...)
+            {
+                range->failed = true;
+                return 0;
+            }
+        }
+
+        return len;
+    }
+
+    CURLClientInterface::CURLClientInterface(size_t maxIdle) : maxIdle_(maxIdle), share_(NULL)
+    {
+        curl_global_init(CURL_GLOBAL_ALL);
+
+        share_ = curl_share_init();
+
+        if (share_ != NULL)
+        {
+            curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, lock_share);
+            curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, unlock_share);
+            curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+            curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+            curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+        }
+    }
+
+    CURLClientInterface::~CURLClientInterface()
+    {
+        for (auto curl : idle_)
+        {
+            curl_easy_cleanup(curl);
+        }
+
+        if (share_ != NULL)
+        {
+            curl_share_cleanup(share_);
+        }
+
+        curl_global_cleanup();
+    }
+
+    void CURLClientInterface::lock_share(CURL *curl, curl_lock_data data, curl_lock_access access, void *param)
+    {
+        static_cast<CURLClientInterface *>(param)->shareMutex_[data].lock();
+    }
+
+    void CURLClientInterface::unlock_share(CURL *curl, curl_lock_data data, void *param)
+    {
+        static_cast<CURLClientInterface *>(param)->shareMutex_[data].unlock();
+    }
+
+    CURL *CURLClientInterface::acquire()
+    {
+        {
+            lock_guard<mutex> lock(poolMutex_);
+
+            if (!idle_.empty())
+            {
+                CURL *curl = idle_.back();
+
+                idle_.pop_back();
+
+                return curl;
+            }
+        }
+
+        return curl_easy_init();
+    }
+
+    void CURLClientInterface::release(CURL *curl)
+    {
+        // keeps the connections and caches, but not the options of the last request
+        curl_easy_reset(curl);
+
+        {
+            lock_guard<mutex> lock(poolMutex_);
+
+            if (idle_.size() < maxIdle_)
+            {
+                idle_.push_back(curl);
+
+                return;
+            }
+        }
+
+        curl_easy_cleanup(curl);
+    }
+
+    int CURLClientInterface::request(http::method method, const string &url, const Headers &http_headers, const string &payload, string &response)
+    {
+        curl_transfer transfer = {payload.data(), payload.size(), NULL, 0, &response, NULL, NULL, 0, 0, NULL};
+
+        return perform(method, url, http_headers, transfer);
+    }
+
+    int CURLClientInterface::request(http::method method, const string &url, const Headers &http_headers, const string &payload,
+                                     const ResponseSink &sink)
+    {
+        curl_transfer transfer = {payload.data(), payload.size(), NULL, 0, NULL, &sink, NULL, 0, 0, NULL};
+
+        return perform(method, url, http_headers, transfer);
+    }
+
+    int CURLClientInterface::request(http::method method, const string &url, const Headers &http_headers, const RequestSource &source,
+                                     ssize_t size, string &response)
+    {
+        curl_transfer transfer = {NULL, 0, &source, size, &response, NULL, NULL, 0, 0, NULL};
+
+        return perform(method, url, http_headers, transfer);
+    }
+
+    int CURLClientInterface::request(http::method method, const string &url, const Headers &http_headers, const char *data, size_t size,
+                                     string &response)
+    {
+        curl_transfer transfer = {data, size, NULL, 0, &response, NULL, NULL, 0, 0, NULL};
+
+        return perform(method, url, http_headers, transfer);
+    }
+
+    int CURLClientInterface::download(const string &url, const ResponseSink &sink, const ProgressCallback &progress)
+    {
+        curl_transfer transfer = {NULL, 0, NULL, 0, NULL, &sink, &progress, 0, 0, NULL};
+
+        return perform(http::GET, url, Headers(), transfer);
+    }
+
+    int CURLClientInterface::download(const string &url, int fd, size_t connections, const ProgressCallback &progress)
+    {
+        curl_head head = {0, false};
+        long responseCode = 0;
+
+        CURL *curl_ = acquire();
+
+        if (curl_ == NULL)
+        {
+            throw Exception("unable to initialize request");
+        }
+
+        curl_easy_setopt(curl_, CURLOPT_URL, url.c_str());
+
+        curl_easy_setopt(curl_, CURLOPT_NOSIGNAL, 1L);
+
+        if (share_ != NULL)
+        {
+            curl_easy_setopt(curl_, CURLOPT_SHARE, share_);
+        }
+
+        curl_easy_setopt(curl_, CURLOPT_NOBODY, 1L);
+
+        curl_easy_setopt(curl_, CURLOPT_FAILONERROR, 1L);
+
+        curl_easy_setopt(curl_, CURLOPT_HEADERFUNCTION, curl_head_header_callback);
+
+        curl_easy_setopt(curl_, CURLOPT_HEADERDATA, &head);
+
+        CURLcode res = curl_easy_perform(curl_);
+
+        if (res == CURLE_OK)
+        {
+            curl_easy_getinfo(curl_, CURLINFO_RESPONSE_CODE, &responseCode);
+        }
+
+        release(curl_);
+
+        connections = std::min(connections, head.length / MIN_RANGE_SIZE);
+
+        // without ranges, or when not worth splitting, use one stream
+        if (res != CURLE_OK || responseCode != 200 || !head.ranges || connections < 2)
+        {
+            return ClientInterface::download(url, fd, connections, progress);
+        }
+
+        // the parts are written where they belong, in any order
+        if (ftruncate(fd, head.length) == -1)
+        {
+            throw Exception(strerror(errno));
+        }
+
+        return downloadRanges(url, fd, head.length, connections, progress);
+    }
+
+    int CURLClientInterface::downloadRanges(const string &url, int fd, size_t size, size_t connections, const ProgressCallback &progress)
     {
-        if (s == NULL) return 0;
+        vector<curl_range> ranges(connections);
+        size_t received = 0;
+        size_t offset = 0;
+        const char *error = NULL;
+        bool ignored = false;
+        int running = 0;
+
+        CURLM *multi = curl_multi_init();
+
+        if (multi == NULL)
+        {
+            throw Exception("unable to initialize request");
+        }
+
+        for (size_t i = 0; i < connections; i++)
+        {
+            curl_range &range = ranges[i];
+
+            range.fd = fd;
+            range.offset = offset;
+            range.length = (i == connections - 1) ? size - offset : size / connections;
+            range.written = 0;
+            range.received = &received;
+            range.total = size;
+            range.progress = &progress;
+            range.failed = false;
+            range.ignored = false;
+            range.curl = acquire();
+
+            offset += range.length;
+
+            if (range.curl == NULL)
+            {
+                error = "unable to initialize request";
+                continue;
+            }
+
+            string bytes = to_string(range.offset) + "-" + to_string(range.offset + range.length - 1);
+
+            curl_easy_setopt(range.curl, CURLOPT_URL, url.c_str());
+
+            curl_easy_setopt(range.curl, CURLOPT_NOSIGNAL, 1L);
+
+            curl_easy_setopt(range.curl, CURLOPT_TCP_KEEPALIVE, 1L);
+
+            if (share_ != NULL)
+            {
+                curl_easy_setopt(range.curl, CURLOPT_SHARE, share_);
+            }
+
+            curl_easy_setopt(range.curl, CURLOPT_RANGE, bytes.c_str());
+
+            curl_easy_setopt(range.curl, CURLOPT_FAILONERROR, 1L);
+
+            curl_easy_setopt(range.curl, CURLOPT_WRITEFUNCTION, curl_write_range_callback);
+
+            curl_easy_setopt(range.curl, CURLOPT_WRITEDATA, &range);
 
-        const size_t new_len = size * nmemb;
+            curl_multi_add_handle(multi, range.curl);
+        }
+
+        while (error == NULL)
+        {
+            curl_multi_perform(multi, &running);
+
+            CURLMsg *msg = NULL;
+            int remaining = 0;
+
+            while ((msg = curl_multi_info_read(multi, &remaining)) != NULL)
+            {
+                if (msg->msg == CURLMSG_DONE && msg->data.result != CURLE_OK)
+                {
+                    error = curl_easy_strerror(msg->data.result);
+                }
+            }
 
-        char buf[new_len + 1];
+            if (running == 0)
+            {
+                break;
+            }
+
+            curl_multi_wait(multi, NULL, 0, RANGE_WAIT_MS, NULL);
+        }
+
+        for (auto &range : ranges)
+        {
+            if (range.curl == NULL)
+            {
+                continue;
+            }
 
-        memcpy(buf, ptr, size * nmemb);
+            curl_multi_remove_handle(multi, range.curl);
 
-        buf[new_len] = '\0';
+            release(range.curl);
+
+            ignored = ignored || range.ignored;
+
+            if (error == NULL && (range.failed || range.written != range.length))
+            {
+                error = "incomplete range in download";
+            }
+        }
+
+        curl_multi_cleanup(multi);
+
+        // the ranges were advertised but not honoured, start over with one stream, and the progress with it
+        if (ignored)
+        {
+            if (progress)
+            {
+                progress(0, 0);
+            }
+
+            return ClientInterface::download(url, fd, 1, progress);
+        }
 
-        s->append(buf);
+        if (error != NULL)
+        {
+            throw Exception(error);
+        }
 
-        return new_len;
+        return 200;
     }
 
-    int CURLClientInterface::request(http::method method, const string &url, map<string, string> http_headers, const string &payload, string &response)
+    int CURLClientInterface::perform(http::method method, const string &url, const Headers &http_headers, curl_transfer &transfer)
     {
         struct curl_slist *headers = NULL;
-        char buf[BUFSIZ + 1] = {0};
-        int responseCode;
+        string line;
+        long responseCode = 0;
 
-        CURL *curl_ = curl_easy_init();
+        CURL *curl_ = acquire();
 
         if (curl_ == NULL)
         {
@@ -45,8 +545,42 @@ namespace cparse
 
         curl_easy_setopt(curl_, CURLOPT_URL, url.c_str());
 
+        curl_easy_setopt(curl_, CURLOPT_NOSIGNAL, 1L);
+
+        curl_easy_setopt(curl_, CURLOPT_TCP_KEEPALIVE, 1L);
+
+        if (share_ != NULL)
+        {
+            curl_easy_setopt(curl_, CURLOPT_SHARE, share_);
+        }
+
         curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, curl_append_response_callback);
 
+        curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &transfer);
+
+        // downloads fail on an error status instead of streaming the error to the sink
+        if (transfer.progress != NULL)
+        {
+            curl_easy_setopt(curl_, CURLOPT_FAILONERROR, 1L);
+        }
+
+        if (transfer.source != NULL)
+        {
+            curl_easy_setopt(curl_, CURLOPT_READFUNCTION, curl_read_request_callback);
+
+            curl_easy_setopt(curl_, CURLOPT_READDATA, &transfer);
+
+            // without a size the body is sent in chunks
+            if (transfer.size < 0)
+            {
+                headers = curl_slist_append(headers, "Transfer-Encoding: chunked");
+            }
+        }
+
+        curl_easy_setopt(curl_, CURLOPT_HEADERFUNCTION, curl_response_header_callback);
+
+        curl_easy_setopt(curl_, CURLOPT_HEADERDATA, &transfer);
+
         switch (method)
         {
         case http::GET:
@@ -54,13 +588,30 @@ namespace cparse
             break;
         case http::POST:
             curl_easy_setopt(curl_, CURLOPT_POST, 1L);
-            curl_easy_setopt(curl_, CURLOPT_POSTFIELDS, payload.c_str());
-            curl_easy_setopt(curl_, CURLOPT_POSTFIELDSIZE, payload.size());
+            if (transfer.source != NULL)
+            {
+                curl_easy_setopt(curl_, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(transfer.size));
+            }
+            else if (transfer.data != NULL)
+            {
+                // curl sends straight from the data without copying it
+                curl_easy_setopt(curl_, CURLOPT_POSTFIELDS, transfer.data);
+                curl_easy_setopt(curl_, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(transfer.length));
+            }
             break;
         case http::PUT:
-            curl_easy_setopt(curl_, CURLOPT_PUT, 1L);
-            curl_easy_setopt(curl_, CURLOPT_POSTFIELDS, payload.c_str());
-            curl_easy_setopt(curl_, CURLOPT_POSTFIELDSIZE, payload.size());
+            if (transfer.source != NULL)
+            {
+                curl_easy_setopt(curl_, CURLOPT_UPLOAD, 1L);
+                curl_easy_setopt(curl_, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(transfer.size));
+            }
+            else if (transfer.data != NULL)
+            {
+                curl_easy_setopt(curl_, CURLOPT_CUSTOMREQUEST, "PUT");
+                curl_easy_setopt(curl_, CURLOPT_POSTFIELDS, transfer.data);
+                curl_easy_setopt(curl_, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(transfer.length));
+            }
+            break;
         case http::DELETE:
             curl_easy_setopt(curl_, CURLOPT_CUSTOMREQUEST, "DELETE");
             break;
@@ -68,59 +619,93 @@ namespace cparse
 
         for (auto & h : http_headers)
         {
-            snprintf(buf, BUFSIZ, "%s: %s", h.first.c_str(), h.second.c_str());
+            line.assign(h.first).append(": ").append(h.second);
 
-            headers = curl_slist_append(headers, buf);
+            headers = curl_slist_append(headers, line.c_str());
         }
 
         curl_easy_setopt(curl_, CURLOPT_HTTPHEADER, headers);
 
-        curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &response);
-
         CURLcode res = curl_easy_perform(curl_);
 
-        if (res != CURLE_OK)
+        if (res == CURLE_OK)
         {
-            curl_easy_cleanup(curl_);
-
-            throw Exception(curl_easy_strerror(res));
+            curl_easy_getinfo(curl_, CURLINFO_RESPONSE_CODE, &responseCode);
         }
 
-        curl_easy_getinfo (curl_, CURLINFO_RESPONSE_CODE, &responseCode);
+        release(curl_);
 
-        curl_easy_cleanup(curl_);
+        curl_slist_free_all(headers);
+
+        if (transfer.aborted != NULL)
+        {
+            throw Exception(transfer.aborted);
+        }
+
+        if (res != CURLE_OK)
+        {
+            throw Exception(curl_easy_strerror(res));
+        }
 
         return responseCode;
     }
 
-    Client::Client() : Client(cparse_client_interface_)
-    {}
+    static mutex default_headers_mutex_;
 
-    Client::Client(ClientInterface *interface) : interface_(interface)
+    static shared_ptr<const Headers> default_headers_;
+
+    shared_ptr<const Headers> Client::defaultHeaders()
     {
-        char version[BUFSIZ + 1] = {0};
+        lock_guard<mutex> lock(default_headers_mutex_);
+
+        if (default_headers_)
+        {
+            return default_headers_;
+        }
+
+        auto headers = make_shared<Headers>();
 
-        headers_[protocol::HEADER_APP_ID] = cparse_app_id_;
+        (*headers)[protocol::HEADER_APP_ID] = cparse_app_id_;
 
-        headers_[protocol::HEADER_API_KEY] = cparse_api_key_;
+        (*headers)[protocol::HEADER_API_KEY] = cparse_api_key_;
 
-        headers_["Content-Type"] = "application/json";
+        (*headers)["Content-Type"] = "application/json";
 
-        User *user = User::currentUser();
+        string sessionToken = User::currentSessionToken();
 
-        if (user != NULL)
+        if (!sessionToken.empty())
         {
-            headers_[protocol::HEADER_SESSION_TOKEN] = user->sessionToken();
+            (*headers)[protocol::HEADER_SESSION_TOKEN] = sessionToken;
         }
 
-        snprintf(version, BUFSIZ, "libcparse-%s", Parse::VERSION);
+        (*headers)["User-Agent"] = string("libcparse-") + Parse::VERSION;
 
-        headers_["User-Agent"] = version;
+        default_headers_ = headers;
+
+        return default_headers_;
     }
 
+    void Client::resetDefaultHeaders()
+    {
+        lock_guard<mutex> lock(default_headers_mutex_);
+
+        default_headers_.reset();
+    }
+
+    Client::Client() : Client(cparse_client_interface_)
+    {}
+
+    Client::Client(ClientInterface *interface) : interface_(interface), headers_(defaultHeaders()), responseCode_(0)
+    {}
+
     void Client::addHeader(const string &name, const string &value)
     {
-        headers_[name] = value;
+        // the headers are shared, so copy before changing them
+        auto headers = make_shared<Headers>(*headers_);
+
+        (*headers)[name] = value;
+
+        headers_ = headers;
     }
 
     string Client::buildUrl(const string &path)
@@ -180,36 +765,53 @@ namespace cparse
 
     void Client::post(const string &path)
     {
-        responseCode_ = interface_->request(http::POST, buildUrl(path), headers_, payload_, response_);
+        responseCode_ = interface_->request(http::POST, buildUrl(path), *headers_, payload_, response_);
     }
 
     void Client::put(const string &path)
     {
-        responseCode_ = interface_->request(http::PUT, buildUrl(path), headers_, payload_, response_);
+        responseCode_ = interface_->request(http::PUT, buildUrl(path), *headers_, payload_, response_);
     }
 
     void Client::get(const string &path)
     {
-        responseCode_ = interface_->request(http::GET, buildUrl(path), headers_, payload_, response_);
+        responseCode_ = interface_->request(http::GET, buildUrl(path), *headers_, payload_, response_);
     }
 
     void Client::de1ete(const string &path)
     {
-        responseCode_ = interface_->request(http::DELETE, buildUrl(path), headers_, payload_, response_);
+        responseCode_ = interface_->request(http::DELETE, buildUrl(path), *headers_, payload_, response_);
     }
 
-    JSON Client::getJSONResponse() const
+    void Client::post(const string &path, const RequestSource &source, ssize_t size)
     {
-        JSON obj;
+        responseCode_ = interface_->request(http::POST, buildUrl(path), *headers_, source, size, response_);
+    }
 
-        if (!obj.parse(response_))
-            throw Exception("reponse is not a valid response");
+    void Client::post(const string &path, const char *data, size_t size)
+    {
+        responseCode_ = interface_->request(http::POST, buildUrl(path), *headers_, data, size, response_);
+    }
 
-        if (obj.contains("error"))
-        {
-            throw Exception(obj.get_string("error"));
-        }
+    void Client::download(const string &url, const ResponseSink &sink, const ProgressCallback &progress)
+    {
+        responseCode_ = interface_->download(url, sink, progress);
+    }
+
+    void Client::download(const string &url, int fd, size_t connections, const ProgressCallback &progress)
+    {
+        responseCode_ = interface_->download(url, fd, connections, progress);
+    }
+
+    int Client::getResponseCode() const
+    {
+        return responseCode_;
+    }
+
+    JSON Client::getJSONResponse() const
+    {
+        Response response = {responseCode_, response_};
 
-        return obj;
+        return response.json();
     }
-}
\ No newline at end of file
+}
@@ -3,16 +3,58 @@
 
 #include <cparse/json.h>
 #include <cparse/clientinterface.h>
+#include <curl/curl.h>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 using namespace std;
 
 namespace cparse
 {
+    struct curl_transfer;
+
+    // Performs requests with a pool of reusable curl handles, so connections, dns lookups
+    // and tls sessions are kept between requests. Safe to use from multiple threads.
     class CURLClientInterface : public ClientInterface
     {
     public:
-        int request(http::method method, const string &url, map<string, string> headers, const string &data, string &response);
+        static const size_t DEFAULT_MAX_IDLE = 8;
+
+        CURLClientInterface(size_t maxIdle = DEFAULT_MAX_IDLE);
+        virtual ~CURLClientInterface();
+        CURLClientInterface(const CURLClientInterface &other) = delete;
+        CURLClientInterface &operator=(const CURLClientInterface &other) = delete;
+
+        int request(http::method method, const string &url, const Headers &headers, const string &data, string &response);
+
+        int request(http::method method, const string &url, const Headers &headers, const string &data, const ResponseSink &sink);
+
+        int request(http::method method, const string &url, const Headers &headers, const RequestSource &source, ssize_t size,
+                    string &response);
+
+        int request(http::method method, const string &url, const Headers &headers, const char *data, size_t size, string &response);
+
+        int download(const string &url, const ResponseSink &sink, const ProgressCallback &progress);
+
+        int download(const string &url, int fd, size_t connections, const ProgressCallback &progress);
+    private:
+        int downloadRanges(const string &url, int fd, size_t size, size_t connections, const ProgressCallback &progress);
+
+        int perform(http::method method, const string &url, const Headers &headers, curl_transfer &transfer);
+
+        CURL *acquire();
+        void release(CURL *curl);
+
+        static void lock_share(CURL *curl, curl_lock_data data, curl_lock_access access, void *param);
+        static void unlock_share(CURL *curl, curl_lock_data data, void *param);
+
+        mutex poolMutex_;
+        vector<CURL *> idle_;
+        size_t maxIdle_;
+        CURLSH *share_;
+        mutex shareMutex_[CURL_LOCK_DATA_LAST];
     };
 
     class Client
@@ -33,15 +75,33 @@ namespace cparse
         void get(const string &path);
         void de1ete(const string &path);
 
+        // posts a body read from a source, the size is negative when unknown
+        void post(const string &path, const RequestSource &source, ssize_t size);
+
+        // posts a body from memory that must stay valid until the request is done, without copying it
+        void post(const string &path, const char *data, size_t size);
+
+        // streams a url outside of the api, without the default headers
+        void download(const string &url, const ResponseSink &sink, const ProgressCallback &progress = ProgressCallback());
+
+        // downloads a url outside of the api into a file, over several connections when possible
+        void download(const string &url, int fd, size_t connections, const ProgressCallback &progress = ProgressCallback());
+
+        int getResponseCode() const;
+
         void addHeader(const string &name, const string &value);
 
         void setPayload(const string &data);
         string getPayload() const;
-    protected:
-        string buildUrl(const string &path);
+
+        // the headers sent with every request, built once and shared until the app keys or user change
+        static shared_ptr<const Headers> defaultHeaders();
+        static void resetDefaultHeaders();
+
+        static string buildUrl(const string &path);
     private:
         ClientInterface *interface_;
-        map<string, string> headers_;
+        shared_ptr<const Headers> headers_;
         string response_;
         string payload_;
         int responseCode_;
@@ -0,0 +1,191 @@
+#ifndef ARG3_CPARSE_ASYNC_CLIENT_H
+#define ARG3_CPARSE_ASYNC_CLIENT_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "clientinterface.h"
+#include "json.h"
+
+namespace cparse
+{
+    // The result of an asynchronous operation. The operation starts when this is created,
+    // so several can be in flight before any are waited on.
+    //
+    // With C++20, `co_await` suspends the coroutine until the result is ready. The coroutine then
+    // resumes on the AsyncClient reactor thread, so it should not block there.
+    // Without coroutines, get() blocks the calling thread instead.
+    template <typename T>
+    class Awaitable
+    {
+    public:
+        typedef std::function<void(T value, std::exception_ptr error)> Callback;
+
+        explicit Awaitable(std::function<void(Callback)> start) : state_(std::make_shared<State>())
+        {
+            auto state = state_;
+
+            start([state](T value, std::exception_ptr error)
+            {
+                std::function<void()> resume;
+
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+
+                    state->value = std::move(value);
+                    state->error = error;
+                    state->done = true;
+
+                    resume = std::move(state->resume);
+                }
+
+                state->ready.notify_all();
+
+                if (resume)
+                {
+                    resume();
+                }
+            });
+        }
+
+        // an already finished result
+        static Awaitable<T> ready(T value)
+        {
+            return Awaitable<T>([&value](Callback done)
+            {
+                done(std::move(value), nullptr);
+            });
+        }
+
+        bool await_ready() const
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+
+            return state_->done;
+        }
+
+        // returns false to resume right away when the result arrived in the meantime
+        template <typename Handle>
+        bool await_suspend(Handle handle)
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+
+            if (state_->done)
+            {
+                return false;
+            }
+
+            state_->resume = [handle]() mutable
+            {
+                handle.resume();
+            };
+
+            return true;
+        }
+
+        T await_resume()
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+
+            if (state_->error)
+            {
+                std::rethrow_exception(state_->error);
+            }
+
+            return std::move(state_->value);
+        }
+
+        // waits for the result, must not be called on the reactor thread
+        T get()
+        {
+            {
+                std::unique_lock<std::mutex> lock(state_->mutex);
+
+                state_->ready.wait(lock, [this]()
+                {
+                    return state_->done;
+                });
+            }
+
+            return await_resume();
+        }
+
+    private:
+        struct State
+        {
+            State() : value(), done(false) {}
+
+            std::mutex mutex;
+            std::condition_variable ready;
+            T value;
+            std::exception_ptr error;
+            std::function<void()> resume;
+            bool done;
+        };
+
+        std::shared_ptr<State> state_;
+    };
+
+    // a response from the api
+    struct Response
+    {
+        int code;
+        string body;
+
+        // parses the body, throws if it is not json or is an api error
+        JSON json() const;
+    };
+
+    // Performs requests without blocking, on a single reactor thread driving curl's multi interface.
+    // Requests use the default headers of Client, but not the ClientInterface set with Parse.
+    class AsyncClient
+    {
+    public:
+        typedef std::function<void(const Response &response, std::exception_ptr error)> ResponseCallback;
+
+        // the client used when none is given, created on first use
+        static AsyncClient &shared();
+
+        AsyncClient();
+        ~AsyncClient();
+        AsyncClient(const AsyncClient &other) = delete;
+        AsyncClient &operator=(const AsyncClient &other) = delete;
+
+        // queues a request to an api path, the callback is called on the reactor thread
+        void send(http::method method, const string &path, const string &payload, ResponseCallback callback, const Headers &headers = Headers());
+
+        Awaitable<Response> request(http::method method, const string &path, const string &payload = string(), const Headers &headers = Headers());
+
+        Awaitable<Response> get(const string &path);
+        Awaitable<Response> post(const string &path, const string &payload);
+        Awaitable<Response> put(const string &path, const string &payload);
+        Awaitable<Response> de1ete(const string &path);
+
+        // true when called from the reactor thread
+        bool inReactor() const;
+
+    private:
+        struct Transfer;
+
+        void run();
+        void start(Transfer *transfer);
+        void finish(Transfer *transfer, int result);
+        void wakeup();
+
+        std::mutex mutex_;
+        std::deque<Transfer *> pending_;
+        std::vector<Transfer *> active_;
+        std::vector<void *> idle_;
+        void *multi_;
+        bool stopping_;
+        std::thread reactor_;
+    };
+}
+
+#endif
@@ -1,7 +1,14 @@
 #ifndef CPARSE_CLIENT_INTERFACE_H_
 #define CPARSE_CLIENT_INTERFACE_H_
 
+#include <cstdio>
+#include <functional>
 #include <map>
+#include <string>
+#include <cerrno>
+#include <sys/types.h>
+#include <unistd.h>
+#include <cparse/exception.h>
 
 using namespace std;
 
@@ -15,11 +22,137 @@ namespace cparse
         } method;
     }
 
+    typedef map<string, string> Headers;
+
+    // Receives the response body as it arrives. Returning false aborts the request.
+    typedef function<bool(const char *data, size_t size)> ResponseSink;
+
+    // Fills a buffer with the next part of a request body. Returns the bytes written, zero at the end.
+    typedef function<size_t(char *buffer, size_t size)> RequestSource;
+
+    // Called as a download arrives, total is zero when the size is unknown.
+    typedef function<void(size_t received, size_t total)> ProgressCallback;
+
     class ClientInterface
     {
     public:
         virtual ~ClientInterface() {}
-        virtual int request(http::method method, const string &url, map<string, string> headers, const string &data, string &response) = 0;
+        virtual int request(http::method method, const string &url, const Headers &headers, const string &data, string &response) = 0;
+
+        // streams the response into a sink, by default after buffering it.
+        // a sink that returns false or throws aborts the response.
+        virtual int request(http::method method, const string &url, const Headers &headers, const string &data, const ResponseSink &sink)
+        {
+            string response;
+
+            int code = request(method, url, headers, data, response);
+
+            if (response.empty())
+            {
+                return code;
+            }
+
+            bool accepted = false;
+
+            try
+            {
+                accepted = sink(response.data(), response.size());
+            }
+            catch (...)
+            {
+                accepted = false;
+            }
+
+            if (!accepted)
+            {
+                throw Exception("response aborted");
+            }
+
+            return code;
+        }
+
+        // sends a body read from a source, the size is negative when unknown.
+        // by default the body is read into memory first.
+        virtual int request(http::method method, const string &url, const Headers &headers, const RequestSource &source, ssize_t size,
+                            string &response)
+        {
+            string data;
+            char buf[BUFSIZ];
+            size_t len = 0;
+
+            if (size > 0)
+            {
+                data.reserve(size);
+            }
+
+            while ((len = source(buf, sizeof(buf))) > 0)
+            {
+                data.append(buf, len);
+            }
+
+            return request(method, url, headers, data, response);
+        }
+
+        // sends a body from memory without copying it into a string, by default after copying it
+        virtual int request(http::method method, const string &url, const Headers &headers, const char *data, size_t size, string &response)
+        {
+            return request(method, url, headers, string(data, size), response);
+        }
+
+        // streams a url into a sink, reporting the progress of each part
+        virtual int download(const string &url, const ResponseSink &sink, const ProgressCallback &progress)
+        {
+            size_t received = 0;
+
+            return request(http::GET, url, Headers(), string(), [&](const char * data, size_t size)
+            {
+                if (!sink(data, size))
+                {
+                    return false;
+                }
+
+                received += size;
+
+                if (progress)
+                {
+                    progress(received, 0);
+                }
+
+                return true;
+            });
+        }
+
+        // downloads a url into a file, over several connections when the server supports ranges.
+        // by default as a single stream. when a server ignores the ranges it advertised, the download
+        // starts over as a single stream, and the progress is first reported as zero of an unknown total.
+        virtual int download(const string &url, int fd, size_t connections, const ProgressCallback &progress)
+        {
+            off_t offset = 0;
+
+            return download(url, [fd, &offset](const char * data, size_t size)
+            {
+                while (size > 0)
+                {
+                    ssize_t count = pwrite(fd, data, size, offset);
+
+                    if (count < 0 && errno == EINTR)
+                    {
+                        continue;
+                    }
+
+                    if (count <= 0)
+                    {
+                        return false;
+                    }
+
+                    data += count;
+                    size -= count;
+                    offset += count;
+                }
+
+                return true;
+            }, progress);
+        }
     };
 }
 
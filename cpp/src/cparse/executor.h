@@ -0,0 +1,63 @@
+#ifndef ARG3_CPARSE_EXECUTOR_H
+#define ARG3_CPARSE_EXECUTOR_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace cparse
+{
+    // A fixed pool of threads running queued tasks, used for the asynchronous operations
+    // so that many requests in flight do not each need a thread of their own.
+    class Executor
+    {
+    public:
+        // the executor used by Object::saveAsync and the like, created on first use
+        static Executor &shared();
+
+        explicit Executor(size_t threads);
+        ~Executor();
+        Executor(const Executor &other) = delete;
+        Executor &operator=(const Executor &other) = delete;
+
+        // queues a task, the future holds its result or exception
+        template <typename F>
+        std::future<typename std::result_of<F()>::type> submit(F &&task)
+        {
+            typedef typename std::result_of<F()>::type result_type;
+
+            auto packaged = std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(task));
+
+            std::future<result_type> result = packaged->get_future();
+
+            post([packaged]()
+            {
+                (*packaged)();
+            });
+
+            return result;
+        }
+
+        // queues a task without a result
+        void post(std::function<void()> task);
+
+        size_t size() const;
+
+    private:
+        void run();
+
+        std::mutex mutex_;
+        std::condition_variable ready_;
+        std::deque<std::function<void()>> tasks_;
+        std::vector<std::thread> threads_;
+        bool stopping_;
+    };
+}
+
+#endif
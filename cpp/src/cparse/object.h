@@ -3,17 +3,25 @@
 
 #include <string>
 #include <map>
+#include <set>
 #include <vector>
 #include <functional>
+#include <memory>
 #include "json.h"
+#include "clientinterface.h"
 #include "type/pointer.h"
 #include <thread>
+#include <future>
 
 namespace cparse
 {
     class Object;
     class User;
     class Pointer;
+    class AsyncClient;
+
+    template <typename T>
+    class Awaitable;
 
     class Object
     {
@@ -29,6 +37,8 @@ namespace cparse
 
         static std::thread saveAllInBackground(std::vector<Object> objects, std::function<void()> callback = nullptr);
 
+        static std::future<bool> saveAllAsync(std::vector<Object> objects);
+
         Object(const std::string &className);
         virtual ~Object();
         Object(const Object &other);
@@ -45,7 +55,10 @@ namespace cparse
         int64_t getInt64(const std::string &key) const;
         double getDouble(const std::string &key) const;
         string getString(const std::string &key) const;
+        // fetched objects are shared between copies, and copied before being returned for changes.
+        // once returned for changes, copies of this object get their own copy instead of sharing it
         Object *getObject(const std::string &key);
+        const Object *getObject(const std::string &key) const;
         User *getUser(const std::string &key);
 
         void set(const std::string &key, const JSON &value);
@@ -68,6 +81,18 @@ namespace cparse
         std::thread fetchInBackground(std::function<void(Object *)> callback = nullptr);
         std::thread destroyInBackground(std::function<void(Object *)> callback = nullptr);
 
+        // run on the shared executor, the object must outlive the future
+        std::future<bool> saveAsync();
+        std::future<bool> fetchAsync();
+        std::future<bool> deleteAsync();
+
+        // performed by an async client without blocking, see cparse/asyncclient.h.
+        // the result is merged into this object on the client's thread, so it must outlive the awaitable
+        Awaitable<bool> save(AsyncClient &client);
+        Awaitable<bool> fetch(AsyncClient &client);
+        Awaitable<bool> de1ete(AsyncClient &client);
+        Awaitable<bool> refresh(AsyncClient &client);
+
         std::string id() const;
 
         time_t createdAt() const;
@@ -92,13 +117,19 @@ namespace cparse
         virtual void merge(JSON attributes);
         virtual void copy_fetched(const Object &obj);
     private:
+        std::string path() const;
+        bool isFetchable() const;
+        Awaitable<bool> request(AsyncClient &client, http::method method, bool merging);
+
         std::string className_;
         time_t createdAt_;
         std::string objectId_;
         time_t updatedAt_;
         JSON attributes_;
         bool dataAvailable_;
-        map<std::string, Object *> fetched_;
+        mutable map<std::string, std::shared_ptr<Object>> fetched_;
+        // the fetched objects returned for changes, which are never shared
+        std::set<std::string> exposed_;
     };
 }
 
@@ -7,6 +7,17 @@
 
 namespace cparse
 {
+    // the codec used for bytes fields
+    namespace base64
+    {
+        string encode(unsigned char const *bytes_to_encode, size_t in_len);
+
+        string encode(const vector<uint8_t> &value);
+
+        // decodes up to the first invalid character
+        vector<uint8_t> decode(const string &encoded_string);
+    }
+
     namespace type
     {
         class Bytes : public ParseType
@@ -1,13 +1,20 @@
 #ifndef ARG3_CPARSE_TYPE_FILE_H_
 #define ARG3_CPARSE_TYPE_FILE_H_
 
+#include <memory>
 #include <string>
 #include "../json.h"
+#include "../clientinterface.h"
 
 using namespace std;
 
 namespace cparse
 {
+    class AsyncClient;
+
+    template <typename T>
+    class Awaitable;
+
     namespace type
     {
         class File
@@ -15,12 +22,20 @@ namespace cparse
         public:
             typedef string ContentType;
 
+            // the connections used to download into a file
+            static const size_t DEFAULT_CONNECTIONS = 4;
+
             File();
             File(const JSON &obj);
             File(const string &fileName, const ContentType &content, const string &contentType);
             File(const File &value);
             File(File &&value);
             virtual ~File();
+
+            // maps a file on disk as the contents, so it is uploaded without being read into memory.
+            // the content type is guessed from the contents when not given. throws if the file can't be mapped.
+            static File fromPath(const string &path, const string &contentType = string());
+
             File &operator=(const File &value);
             File &operator=(File && value);
 
@@ -39,12 +54,27 @@ namespace cparse
 
             bool save();
 
+            // streams the contents from a file descriptor, from its offset to the end, instead of the contents in memory
+            bool save(int fd);
+
+            // streams the contents at the url to a sink, without keeping them in memory
+            bool download(const ResponseSink &sink, const ProgressCallback &progress = ProgressCallback()) const;
+
+            // downloads the contents at the url into a file, splitting it between connections when the server supports ranges
+            bool download(const string &path, size_t connections = DEFAULT_CONNECTIONS, const ProgressCallback &progress = ProgressCallback()) const;
+
+            // uploaded by an async client without blocking, see cparse/asyncclient.h.
+            // the response updates this file on the client's thread, so it must outlive the awaitable
+            Awaitable<bool> save(AsyncClient &client);
+
         private:
             string localFileName_;
             string parseFileName_;
             string contentType_;
             ContentType body_;
             string url_;
+            shared_ptr<const char> mapping_;
+            size_t mappingSize_;
         };
     }
 }
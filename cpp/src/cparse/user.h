@@ -11,10 +11,12 @@ namespace cparse
     class User : public Object
     {
     public:
+        // the current user is deleted when replaced by authenticate or logout, so don't keep the pointer past that
         static User *currentUser();
         static void logout();
         static void enableAutomaticUser();
         static User *authenticate(const string &username, const string &password);
+        static Awaitable<User *> authenticate(AsyncClient &client, const string &username, const string &password);
         User();
         User(const User &other);
         User(User &&other);
@@ -31,6 +33,12 @@ namespace cparse
     protected:
         virtual void merge(JSON value);
     private:
+        friend class Client;
+
+        // the session token of the current user, read under the same lock that replaces it
+        static string currentSessionToken();
+        static User *setCurrentUser(User *user);
+
         static User *currentUser_;
 
         string username_;
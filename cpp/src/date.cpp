@@ -1,6 +1,7 @@
 #include <cparse/type/date.h>
 #include <cparse/exception.h>
 #include "protocol.h"
+#include "iso8601.h"
 
 namespace cparse
 {
@@ -8,12 +9,13 @@ namespace cparse
     {
         void Date::fromString(const std::string &s)
         {
-            struct tm tp;
+            long long millis = 0;
 
-            if (!strptime(s.c_str(), FORMAT, &tp))
+            if (!cparse_iso8601_parse(s.c_str(), &millis))
                 throw Exception("unable to convert time string");
 
-            value_ = mktime(&tp);
+            /* round towards negative infinity for dates before the epoch, like cparse_date_time */
+            value_ = millis >= 0 ? millis / 1000 : (millis - 999) / 1000;
         }
 
         const char *const Date::FORMAT = "%FT%T%z";
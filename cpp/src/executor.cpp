@@ -0,0 +1,97 @@
+#include <cparse/executor.h>
+#include <cparse/exception.h>
+#include <algorithm>
+
+namespace cparse
+{
+    // requests mostly wait on the network, so use more threads than cores
+    static const size_t MIN_SHARED_THREADS = 4;
+
+    Executor &Executor::shared()
+    {
+        static Executor executor(std::max<size_t>(MIN_SHARED_THREADS, std::thread::hardware_concurrency() * 2));
+
+        return executor;
+    }
+
+    Executor::Executor(size_t threads) : stopping_(false)
+    {
+        if (threads == 0)
+        {
+            threads = 1;
+        }
+
+        threads_.reserve(threads);
+
+        for (size_t i = 0; i < threads; i++)
+        {
+            threads_.emplace_back(&Executor::run, this);
+        }
+    }
+
+    Executor::~Executor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            stopping_ = true;
+        }
+
+        ready_.notify_all();
+
+        for (auto &thread : threads_)
+        {
+            thread.join();
+        }
+    }
+
+    void Executor::post(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            if (stopping_)
+            {
+                throw Exception("executor is stopping");
+            }
+
+            tasks_.push_back(std::move(task));
+        }
+
+        ready_.notify_one();
+    }
+
+    size_t Executor::size() const
+    {
+        return threads_.size();
+    }
+
+    void Executor::run()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+
+                ready_.wait(lock, [this]()
+                {
+                    return stopping_ || !tasks_.empty();
+                });
+
+                // finish queued tasks before stopping
+                if (tasks_.empty())
+                {
+                    return;
+                }
+
+                task = std::move(tasks_.front());
+
+                tasks_.pop_front();
+            }
+
+            task();
+        }
+    }
+}
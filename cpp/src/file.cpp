@@ -1,35 +1,194 @@
 #include <cparse/type/file.h>
 #include "client.h"
+#include <cparse/asyncclient.h>
 #include "protocol.h"
+#include <algorithm>
+#include <cerrno>
+#include <cctype>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace cparse
 {
     namespace type
     {
-        File::File(const JSON &obj)
+        // how much of a file is looked at to guess its content type
+        static const size_t SNIFF_SIZE = 512;
+
+        static bool starts_with(const char *data, size_t size, const char *prefix, size_t length)
+        {
+            return size >= length && !memcmp(data, prefix, length);
+        }
+
+        // guesses a content type from the first bytes of a file
+        string sniff_content_type(const char *data, size_t size)
+        {
+            static const struct
+            {
+                const char *magic;
+                size_t length;
+                const char *type;
+            } signatures[] =
+            {
+                {"\x89PNG\r\n\x1a\n", 8, "image/png"},
+                {"\xff\xd8\xff", 3, "image/jpeg"},
+                {"GIF87a", 6, "image/gif"},
+                {"GIF89a", 6, "image/gif"},
+                {"%PDF-", 5, "application/pdf"},
+                {"PK\x03\x04", 4, "application/zip"},
+                {"\x1f\x8b", 2, "application/gzip"},
+                {"ID3", 3, "audio/mpeg"},
+                {"OggS", 4, "audio/ogg"},
+                {"\x1a\x45\xdf\xa3", 4, "video/webm"}
+            };
+
+            for (auto &sig : signatures)
+            {
+                if (starts_with(data, size, sig.magic, sig.length))
+                {
+                    return sig.type;
+                }
+            }
+
+            if (starts_with(data, size, "RIFF", 4) && size >= 12)
+            {
+                if (!memcmp(data + 8, "WEBP", 4))
+                    return "image/webp";
+
+                if (!memcmp(data + 8, "WAVE", 4))
+                    return "audio/wav";
+            }
+
+            if (size >= 8 && !memcmp(data + 4, "ftyp", 4))
+            {
+                return "video/mp4";
+            }
+
+            if (size == 0)
+            {
+                return "application/octet-stream";
+            }
+
+            size_t length = std::min(size, SNIFF_SIZE);
+
+            // text has no control characters besides whitespace
+            for (size_t i = 0; i < length; i++)
+            {
+                unsigned char c = data[i];
+
+                if (c < 0x20 && c != '\t' && c != '\n' && c != '\r' && c != '\f')
+                {
+                    return "application/octet-stream";
+                }
+            }
+
+            size_t start = 0;
+
+            while (start < length && isspace(static_cast<unsigned char>(data[start])))
+            {
+                start++;
+            }
+
+            if (start < length && (data[start] == '{' || data[start] == '['))
+            {
+                return "application/json";
+            }
+
+            if (start < length && data[start] == '<')
+            {
+                return starts_with(data + start, length - start, "<?xml", 5) ? "application/xml" : "text/html";
+            }
+
+            return "text/plain";
+        }
+
+        File File::fromPath(const string &path, const string &contentType)
+        {
+            File file;
+            struct stat st;
+
+            int fd = open(path.c_str(), O_RDONLY);
+
+            if (fd == -1)
+            {
+                throw Exception(path + ": " + strerror(errno));
+            }
+
+            if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode))
+            {
+                close(fd);
+
+                throw Exception(path + ": not a regular file");
+            }
+
+            // an empty file can't be mapped, and has nothing to send anyway
+            if (st.st_size > 0)
+            {
+                size_t size = st.st_size;
+
+                void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+                if (data == MAP_FAILED)
+                {
+                    int err = errno;
+
+                    close(fd);
+
+                    throw Exception(path + ": " + strerror(err));
+                }
+
+                // it is read once, front to back
+                madvise(data, size, MADV_SEQUENTIAL);
+
+                file.mapping_ = shared_ptr<const char>(static_cast<const char *>(data), [size](const char * ptr)
+                {
+                    munmap(const_cast<char *>(ptr), size);
+                });
+
+                file.mappingSize_ = size;
+            }
+
+            close(fd);
+
+            size_t slash = path.rfind('/');
+
+            file.localFileName_ = slash == string::npos ? path : path.substr(slash + 1);
+
+            file.contentType_ = contentType.empty() ? sniff_content_type(file.mapping_.get(), file.mappingSize_) : contentType;
+
+            return file;
+        }
+
+        File::File(const JSON &obj) : mappingSize_(0)
         {
             fromJSON(obj);
         }
 
         File::File(const string &fileName, const ContentType &content, const string &contentType) :
-            localFileName_(fileName), contentType_(contentType), body_(content)
+            localFileName_(fileName), contentType_(contentType), body_(content), mappingSize_(0)
         {
 
         }
 
-        File::File()
+        File::File() : mappingSize_(0)
         {}
 
         File::~File()
         {}
 
         File::File(const File &value) : localFileName_(value.localFileName_), parseFileName_(value.parseFileName_),
-            contentType_(value.contentType_), body_(value.body_), url_(value.url_)
+            contentType_(value.contentType_), body_(value.body_), url_(value.url_), mapping_(value.mapping_), mappingSize_(value.mappingSize_)
         {}
 
         File::File(File &&value) : localFileName_(std::move(value.localFileName_)), parseFileName_(std::move(value.parseFileName_)),
-            contentType_(std::move(value.contentType_)), body_(std::move(value.body_)), url_(std::move(value.url_))
-        {}
+            contentType_(std::move(value.contentType_)), body_(std::move(value.body_)), url_(std::move(value.url_)),
+            mapping_(std::move(value.mapping_)), mappingSize_(value.mappingSize_)
+        {
+            value.mappingSize_ = 0;
+        }
 
         File &File::operator=(const File &a)
         {
@@ -40,6 +199,8 @@ namespace cparse
                 contentType_ = a.contentType_;
                 body_ = a.body_;
                 url_ = a.url_;
+                mapping_ = a.mapping_;
+                mappingSize_ = a.mappingSize_;
             }
             return *this;
         }
@@ -53,6 +214,9 @@ namespace cparse
                 contentType_ = std::move(a.contentType_);
                 body_ = std::move(a.body_);
                 url_ = std::move(a.url_);
+                mapping_ = std::move(a.mapping_);
+                mappingSize_ = a.mappingSize_;
+                a.mappingSize_ = 0;
             }
             return *this;
         }
@@ -74,7 +238,7 @@ namespace cparse
                 url_ = obj.get_string("url");
 
             if (obj.contains("body"))
-                body_ = obj.get_string("body");
+                setContents(obj.get_string("body"));
         }
 
         JSON File::toJSON() const
@@ -104,6 +268,11 @@ namespace cparse
         }
         File::ContentType File::getContents() const
         {
+            if (mapping_)
+            {
+                return ContentType(mapping_.get(), mappingSize_);
+            }
+
             return body_;
         }
         string File::getUrl() const
@@ -122,6 +291,10 @@ namespace cparse
         void File::setContents(const ContentType &value)
         {
             body_ = value;
+
+            mapping_.reset();
+
+            mappingSize_ = 0;
         }
 
         bool File::save()
@@ -130,13 +303,71 @@ namespace cparse
 
             client.addHeader("Content-Type", contentType_);
 
-            client.setPayload(body_);
+            JSON response;
+
+            try
+            {
+                if (mapping_)
+                {
+                    client.post("files/" + localFileName_, mapping_.get(), mappingSize_);
+                }
+                else
+                {
+                    client.setPayload(body_);
+
+                    client.post("files/" + localFileName_);
+                }
+
+                response = client.getJSONResponse();
+            }
+            catch (const exception &e)
+            {
+                return false;
+            }
+            fromJSON(response);
+            return true;
+        }
+
+        bool File::save(int fd)
+        {
+            Client client;
+            struct stat st;
+            ssize_t size = -1;
+
+            // only regular files have a known size left to send
+            if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+            {
+                off_t offset = lseek(fd, 0, SEEK_CUR);
+
+                if (offset >= 0 && offset <= st.st_size)
+                {
+                    size = st.st_size - offset;
+                }
+            }
+
+            client.addHeader("Content-Type", contentType_);
 
             JSON response;
 
             try
             {
-                client.post("files/" + localFileName_);
+                client.post("files/" + localFileName_, [fd](char * buffer, size_t len) -> size_t
+                {
+                    ssize_t count = 0;
+
+                    do
+                    {
+                        count = read(fd, buffer, len);
+                    }
+                    while (count < 0 && errno == EINTR);
+
+                    if (count < 0)
+                    {
+                        throw Exception(strerror(errno));
+                    }
+
+                    return count;
+                }, size);
 
                 response = client.getJSONResponse();
             }
@@ -148,5 +379,103 @@ namespace cparse
             return true;
         }
 
+        bool File::download(const ResponseSink &sink, const ProgressCallback &progress) const
+        {
+            Client client;
+
+            if (url_.empty())
+            {
+                return false;
+            }
+
+            try
+            {
+                client.download(url_, sink, progress);
+            }
+            catch (const exception &e)
+            {
+                return false;
+            }
+
+            return client.getResponseCode() / 100 == 2;
+        }
+
+        bool File::download(const string &path, size_t connections, const ProgressCallback &progress) const
+        {
+            Client client;
+
+            if (url_.empty())
+            {
+                return false;
+            }
+
+            int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+            if (fd == -1)
+            {
+                return false;
+            }
+
+            bool success = false;
+
+            try
+            {
+                client.download(url_, fd, connections, progress);
+
+                success = client.getResponseCode() / 100 == 2;
+            }
+            catch (const exception &e)
+            {
+                success = false;
+            }
+
+            if (close(fd) == -1)
+            {
+                success = false;
+            }
+
+            // don't leave a partial file behind
+            if (!success)
+            {
+                unlink(path.c_str());
+            }
+
+            return success;
+        }
+
+        Awaitable<bool> File::save(AsyncClient &client)
+        {
+            Headers headers;
+
+            headers["Content-Type"] = contentType_;
+
+            return Awaitable<bool>([this, &client, &headers](Awaitable<bool>::Callback done)
+            {
+                client.send(http::POST, "files/" + localFileName_, getContents(), [this, done](const Response & response, std::exception_ptr error)
+                {
+                    JSON json;
+
+                    if (error)
+                    {
+                        done(false, nullptr);
+                        return;
+                    }
+
+                    try
+                    {
+                        json = response.json();
+                    }
+                    catch (const exception &e)
+                    {
+                        done(false, nullptr);
+                        return;
+                    }
+
+                    fromJSON(json);
+
+                    done(true, nullptr);
+                }, headers);
+            });
+        }
     }
 }
\ No newline at end of file
@@ -1,28 +1,29 @@
 #include <cparse/object.h>
 #include <cparse/exception.h>
+#include <cparse/executor.h>
+#include <cparse/asyncclient.h>
+#include <atomic>
 #include "util.h"
 #include <cparse/user.h>
 #include "protocol.h"
 #include "client.h"
+#include "iso8601.h"
 
 using namespace std;
 
 namespace cparse
 {
-    time_t datetime(const std::string &s, const std::string &format)
+    time_t datetime(const string &s)
     {
-        struct tm tp;
+        long long millis = 0;
 
-        if (!strptime(s.c_str(), format.c_str(), &tp))
+        if (!cparse_iso8601_parse(s.c_str(), &millis))
             return 0;
 
-        return mktime(&tp);
+        /* round towards negative infinity for dates before the epoch, like cparse_date_time */
+        return millis >= 0 ? millis / 1000 : (millis - 999) / 1000;
     }
 
-    time_t datetime(const string &s)
-    {
-        return datetime(s, "%FT%T%z");
-    }
     bool validate_class_name(const string &value)
     {
 
@@ -92,30 +93,30 @@ namespace cparse
         updatedAt_(other.updatedAt_),
         attributes_(std::move(other.attributes_)),
         dataAvailable_(other.dataAvailable_),
-        fetched_(std::move(other.fetched_))
+        fetched_(std::move(other.fetched_)),
+        exposed_(std::move(other.exposed_))
     {
     }
 
     Object::~Object()
-    {
-        for (auto &e : fetched_)
-        {
-            if (e.second)
-            {
-                delete e.second;
-            }
-        }
-    }
+    {}
 
     void Object::copy_fetched(const Object &obj)
     {
+        // shares the objects, they are copied on write by getObject.
+        // one that may be changed through a pointer already returned is copied now
         for (auto &e : obj.fetched_)
         {
-            if (fetched_[e.first] != NULL)
+            if (obj.exposed_.count(e.first))
             {
-                delete fetched_[e.first];
+                fetched_[e.first] = std::make_shared<Object>(*e.second);
             }
-            fetched_[e.first] = new Object(*e.second);
+            else
+            {
+                fetched_[e.first] = e.second;
+            }
+
+            exposed_.erase(e.first);
         }
     }
 
@@ -147,6 +148,7 @@ namespace cparse
             attributes_ = std::move(other.attributes_);
             dataAvailable_ = other.dataAvailable_;
             fetched_ = std::move(other.fetched_);
+            exposed_ = std::move(other.exposed_);
         }
 
         return *this;
@@ -232,22 +234,48 @@ namespace cparse
 
     Object *Object::getObject(const string &key)
     {
-        if (fetched_.find(key) != fetched_.end())
-            return fetched_[key];
+        // fetches it from the pointer attribute if needed
+        if (static_cast<const Object *>(this)->getObject(key) == NULL)
+        {
+            return NULL;
+        }
+
+        auto it = fetched_.find(key);
+
+        // another object shares it, so copy before it can be changed
+        if (it->second.use_count() > 1)
+        {
+            it->second = std::make_shared<Object>(*it->second);
+        }
+
+        exposed_.insert(key);
+
+        return it->second.get();
+    }
+
+    const Object *Object::getObject(const string &key) const
+    {
+        auto it = fetched_.find(key);
+
+        if (it != fetched_.end())
+            return it->second.get();
 
         JSON val = get(key);
 
         if (!val.contains(protocol::KEY_TYPE) || val.get_string(protocol::KEY_TYPE) != protocol::TYPE_POINTER)
             return NULL;
 
-        fetched_[key] = Object::create(val.get_string(protocol::KEY_CLASS_NAME), val);
+        std::shared_ptr<Object> obj(Object::create(val.get_string(protocol::KEY_CLASS_NAME), val));
 
-        return fetched_[key];
+        fetched_[key] = obj;
+
+        return obj.get();
     }
 
     User *Object::getUser(const string &key)
     {
-        return static_cast<User *>(fetched_[key]);
+        // shares the copy on write of getObject
+        return static_cast<User *>(getObject(key));
     }
 
     void Object::set(const string &key, const JSON &value)
@@ -290,11 +318,9 @@ namespace cparse
         attributes_.set(key, value);
 
         // create the fetched object
-        if (fetched_[key] != NULL)
-        {
-            delete fetched_[key];
-        }
-        fetched_[key] = new Object(obj);
+        fetched_[key] = std::make_shared<Object>(obj);
+
+        exposed_.erase(key);
     }
     void Object::remove(const string &key)
     {
@@ -315,7 +341,6 @@ namespace cparse
     {
         JSON response;
         Client client;
-        char buf[BUFSIZ + 1] = {0};
 
         client.setPayload(attributes_.to_string());
 
@@ -324,13 +349,11 @@ namespace cparse
             /* build the request based on the id */
             if (objectId_.empty())
             {
-                snprintf(buf, BUFSIZ, "%s/%s", protocol::OBJECTS_PATH, className_.c_str());
-                client.post(buf);
+                client.post(path());
             }
             else
             {
-                snprintf(buf, BUFSIZ, "%s/%s/%s", protocol::OBJECTS_PATH, className_.c_str(), objectId_.c_str());
-                client.put(buf);
+                client.put(path());
             }
 
             response = client.getJSONResponse();
@@ -350,13 +373,21 @@ namespace cparse
 
     std::thread Object::saveInBackground(std::function<void(Object *)> callback)
     {
-        return std::thread([&]()
+        return std::thread([this, callback]()
         {
             if (save() && callback != nullptr)
                 callback(this);
         });
     }
 
+    std::future<bool> Object::saveAsync()
+    {
+        return Executor::shared().submit([this]()
+        {
+            return save();
+        });
+    }
+
     bool Object::refresh()
     {
         if (objectId_.empty())
@@ -366,13 +397,10 @@ namespace cparse
 
         Client client;
         JSON response;
-        char buf[BUFSIZ + 1] = {0};
 
         try
         {
-            snprintf(buf, BUFSIZ, "%s/%s/%s", protocol::OBJECTS_PATH, className_.c_str(), objectId_.c_str());
-
-            client.get(buf);
+            client.get(path());
 
             response = client.getJSONResponse();
         }
@@ -388,32 +416,17 @@ namespace cparse
 
     bool Object::fetch()
     {
-        if (objectId_.empty())
-        {
-            return false;
-        }
-
-        if (!contains(protocol::KEY_TYPE))
-        {
-            return false;
-        }
-
-        string type = getString(protocol::KEY_TYPE);
-
-        if (type != protocol::TYPE_POINTER)
+        if (!isFetchable())
         {
             return false;
         }
 
         Client client;
-        char buf[BUFSIZ + 1] = {0};
         JSON response;
 
         try
         {
-            snprintf(buf, BUFSIZ, "%s/%s/%s", protocol::OBJECTS_PATH, className_.c_str(), objectId_.c_str());
-
-            client.get(buf);
+            client.get(path());
 
             response = client.getJSONResponse();
         }
@@ -431,13 +444,21 @@ namespace cparse
 
     std::thread Object::fetchInBackground(std::function<void(Object *)> callback)
     {
-        return std::thread([&]()
+        return std::thread([this, callback]()
         {
             if (fetch() && callback != nullptr)
                 callback(this);
         });
     }
 
+    std::future<bool> Object::fetchAsync()
+    {
+        return Executor::shared().submit([this]()
+        {
+            return fetch();
+        });
+    }
+
     bool Object::saveAll(std::vector<Object> objects)
     {
         bool success = true;
@@ -452,17 +473,70 @@ namespace cparse
 
     std::thread Object::saveAllInBackground(std::vector<Object> objects, std::function<void()> callback)
     {
-        return std::thread([&]()
+        return std::thread([callback](std::vector<Object> objects)
         {
-            if (saveAll(objects) && callback != nullptr)
+            if (saveAll(std::move(objects)) && callback != nullptr)
                 callback();
-        });
+        }, std::move(objects));
+    }
+
+    std::future<bool> Object::saveAllAsync(std::vector<Object> objects)
+    {
+        // the saves run together on the executor, and the last one to finish sets the result
+        struct SaveAll
+        {
+            std::vector<Object> objects;
+            std::atomic<size_t> remaining;
+            std::atomic<bool> success;
+            std::promise<bool> done;
+        };
+
+        auto state = std::make_shared<SaveAll>();
+
+        state->objects = std::move(objects);
+        state->remaining = state->objects.size();
+        state->success = true;
+
+        std::future<bool> result = state->done.get_future();
+
+        if (state->objects.empty())
+        {
+            state->done.set_value(true);
+            return result;
+        }
+
+        for (size_t i = 0; i < state->objects.size(); i++)
+        {
+            Executor::shared().post([state, i]()
+            {
+                bool saved = false;
+
+                try
+                {
+                    saved = state->objects[i].save();
+                }
+                catch (...)
+                {
+                }
+
+                if (!saved)
+                {
+                    state->success = false;
+                }
+
+                if (--state->remaining == 0)
+                {
+                    state->done.set_value(state->success);
+                }
+            });
+        }
+
+        return result;
     }
 
     bool Object::de1ete()
     {
         Client client;
-        char buf[BUFSIZ + 1] = {0};
 
         if (objectId_.empty())
         {
@@ -472,8 +546,7 @@ namespace cparse
         /* do the deed */
         try
         {
-            snprintf(buf, BUFSIZ, "%s/%s/%s", protocol::OBJECTS_PATH, className_.c_str(), objectId_.c_str());
-            client.de1ete(buf);
+            client.de1ete(path());
         }
         catch (const exception &e)
         {
@@ -485,13 +558,117 @@ namespace cparse
 
     std::thread Object::destroyInBackground(std::function<void(Object *)> callback)
     {
-        return std::thread([&]()
+        return std::thread([this, callback]()
         {
             if (de1ete() && callback != nullptr)
                 callback(this);
         });
     }
 
+    std::future<bool> Object::deleteAsync()
+    {
+        return Executor::shared().submit([this]()
+        {
+            return de1ete();
+        });
+    }
+
+    string Object::path() const
+    {
+        string path = string(protocol::OBJECTS_PATH) + "/" + className_;
+
+        if (!objectId_.empty())
+        {
+            path.append("/").append(objectId_);
+        }
+
+        return path;
+    }
+
+    bool Object::isFetchable() const
+    {
+        if (objectId_.empty() || !contains(protocol::KEY_TYPE))
+        {
+            return false;
+        }
+
+        return getString(protocol::KEY_TYPE) == protocol::TYPE_POINTER;
+    }
+
+    Awaitable<bool> Object::request(AsyncClient &client, http::method method, bool merging)
+    {
+        string payload = (method == http::POST || method == http::PUT) ? attributes_.to_string() : string();
+
+        return Awaitable<bool>([this, &client, method, merging, &payload](Awaitable<bool>::Callback done)
+        {
+            client.send(method, path(), payload, [this, merging, done](const Response & response, std::exception_ptr error)
+            {
+                JSON json;
+
+                if (error)
+                {
+                    done(false, nullptr);
+                    return;
+                }
+
+                try
+                {
+                    json = response.json();
+                }
+                catch (const exception &e)
+                {
+                    done(false, nullptr);
+                    return;
+                }
+
+                /* merge the result with the object */
+                if (merging)
+                {
+                    merge(json);
+
+                    dataAvailable_ = true;
+                }
+
+                done(true, nullptr);
+            });
+        });
+    }
+
+    Awaitable<bool> Object::save(AsyncClient &client)
+    {
+        return request(client, objectId_.empty() ? http::POST : http::PUT, true);
+    }
+
+    Awaitable<bool> Object::refresh(AsyncClient &client)
+    {
+        if (objectId_.empty())
+        {
+            return Awaitable<bool>::ready(false);
+        }
+
+        return request(client, http::GET, true);
+    }
+
+    Awaitable<bool> Object::fetch(AsyncClient &client)
+    {
+        if (!isFetchable())
+        {
+            return Awaitable<bool>::ready(false);
+        }
+
+        return request(client, http::GET, true);
+    }
+
+    Awaitable<bool> Object::de1ete(AsyncClient &client)
+    {
+        if (objectId_.empty())
+        {
+            return Awaitable<bool>::ready(false);
+        }
+
+        return request(client, http::DELETE, false);
+    }
+
     bool Object::isDataAvailable() const
     {
         return dataAvailable_;
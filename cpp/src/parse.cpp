@@ -54,11 +54,15 @@ namespace cparse
     void Parse::set_application_id(const string &appId)
     {
         cparse_app_id_ = appId;
+
+        Client::resetDefaultHeaders();
     }
 
     void Parse::set_api_key(const string &apiKey)
     {
         cparse_api_key_ = apiKey;
+
+        Client::resetDefaultHeaders();
     }
 
     void Parse::set_facebook_application_id(const string &appId)
@@ -1,6 +1,8 @@
 #include <cparse/user.h>
 #include "client.h"
+#include <cparse/asyncclient.h>
 #include "protocol.h"
+#include <mutex>
 
 namespace cparse
 {
@@ -8,8 +10,13 @@ namespace cparse
 
     bool User::automaticUser_ = false;
 
+    // guards the current user, which async clients replace on their own thread
+    static mutex current_user_mutex_;
+
     User *User::currentUser()
     {
+        lock_guard<mutex> lock(current_user_mutex_);
+
         if (currentUser_ == NULL && automaticUser_)
         {
             currentUser_ = new User();
@@ -17,13 +24,36 @@ namespace cparse
         return currentUser_;
     }
 
-    void User::logout()
+    string User::currentSessionToken()
+    {
+        lock_guard<mutex> lock(current_user_mutex_);
+
+        return currentUser_ == NULL ? string() : currentUser_->sessionToken_;
+    }
+
+    User *User::setCurrentUser(User *user)
     {
-        if (currentUser_)
+        User *previous;
+
         {
-            delete currentUser_;
-            currentUser_ = NULL;
+            lock_guard<mutex> lock(current_user_mutex_);
+
+            previous = currentUser_;
+
+            currentUser_ = user;
         }
+
+        delete previous;
+
+        // outside the lock, as the default headers read the current user under their own
+        Client::resetDefaultHeaders();
+
+        return user;
+    }
+
+    void User::logout()
+    {
+        setCurrentUser(NULL);
     }
 
     User *User::authenticate(const string &username, const string &password)
@@ -52,18 +82,60 @@ namespace cparse
             return NULL;
         }
 
-        if (currentUser_ != NULL)
-            delete currentUser_;
+        User *user = new User();
 
-        currentUser_ = new User();
+        user->setUsername(username);
 
-        currentUser_->setUsername(username);
+        user->setPassword(password);
 
-        currentUser_->setPassword(password);
+        user->merge(response);
 
-        currentUser_->merge(response);
+        return setCurrentUser(user);
+    }
 
-        return currentUser_;
+    Awaitable<User *> User::authenticate(AsyncClient &client, const string &username, const string &password)
+    {
+        JSON body;
+
+        body.set_string("username", username);
+
+        body.set_string("password", password);
+
+        string payload = body.to_string();
+
+        return Awaitable<User *>([&client, username, password, &payload](Awaitable<User *>::Callback done)
+        {
+            client.send(http::GET, "login", payload, [username, password, done](const Response & response, std::exception_ptr error)
+            {
+                JSON json;
+
+                if (error)
+                {
+                    done(NULL, nullptr);
+                    return;
+                }
+
+                try
+                {
+                    json = response.json();
+                }
+                catch (const exception &e)
+                {
+                    done(NULL, nullptr);
+                    return;
+                }
+
+                User *user = new User();
+
+                user->setUsername(username);
+
+                user->setPassword(password);
+
+                user->merge(json);
+
+                done(setCurrentUser(user), nullptr);
+            });
+        });
     }
 
     User::User() : Object(protocol::CLASS_USER)
@@ -113,7 +185,20 @@ namespace cparse
 
         if (attributes.contains(protocol::KEY_USER_SESSION_TOKEN))
         {
-            sessionToken_ = attributes.remove(protocol::KEY_USER_SESSION_TOKEN);
+            bool current;
+
+            {
+                lock_guard<mutex> lock(current_user_mutex_);
+
+                sessionToken_ = attributes.remove(protocol::KEY_USER_SESSION_TOKEN);
+
+                current = this == currentUser_;
+            }
+
+            if (current)
+            {
+                Client::resetDefaultHeaders();
+            }
         }
 
         if (attributes.contains(protocol::KEY_USER_EMAIL))
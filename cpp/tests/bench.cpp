@@ -0,0 +1,130 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include <cparse/type/bytes.h>
+
+using namespace std;
+
+// Measures the base64 codec used for Bytes fields, with a small value and a 1 MB value.
+// usage: bench_cparse [--quick]
+
+static unsigned long alloc_count = 0;
+
+static size_t alloc_bytes = 0;
+
+void *operator new(size_t size)
+{
+    void *ptr = malloc(size ? size : 1);
+
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    alloc_count++;
+    alloc_bytes += size;
+
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+namespace
+{
+    // keeps the compiler from removing unused results
+    volatile size_t sink = 0;
+
+    double min_seconds = 0.5;
+
+    template <typename F>
+    void run(const char *name, F func)
+    {
+        unsigned long iterations = 1, allocs = 0;
+        size_t bytes = 0;
+        double elapsed = 0;
+
+        // warm up
+        func();
+
+        for (;;)
+        {
+            auto start = chrono::steady_clock::now();
+
+            allocs = alloc_count;
+            bytes = alloc_bytes;
+
+            for (unsigned long i = 0; i < iterations; i++)
+            {
+                func();
+            }
+
+            elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+            allocs = alloc_count - allocs;
+            bytes = alloc_bytes - bytes;
+
+            if (elapsed >= min_seconds || iterations >= (1UL << 30))
+            {
+                break;
+            }
+
+            iterations *= 2;
+        }
+
+        printf("%-24s %12lu %14.1f %12.1f %14.0f\n", name, iterations, elapsed * 1e9 / iterations,
+               static_cast<double>(allocs) / iterations, static_cast<double>(bytes) / iterations);
+    }
+
+    vector<uint8_t> corpus(size_t size)
+    {
+        vector<uint8_t> data(size);
+        unsigned int seed = 1;
+
+        for (auto &byte : data)
+        {
+            seed = seed * 1103515245 + 12345;
+            byte = static_cast<uint8_t>(seed >> 16);
+        }
+        return data;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && !strcmp(argv[1], "--quick"))
+    {
+        min_seconds = 0.05;
+    }
+
+    const vector<uint8_t> small = corpus(48);
+    const vector<uint8_t> large = corpus(1024 * 1024);
+    const string smallText = cparse::base64::encode(small);
+    const string largeText = cparse::base64::encode(large);
+
+    if (cparse::base64::decode(largeText) != large)
+    {
+        fprintf(stderr, "base64 round trip failed\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%-24s %12s %14s %12s %14s\n", "benchmark", "iterations", "ns/op", "allocs/op", "bytes/op");
+
+    run("base64_encode_small", [&]() { sink += cparse::base64::encode(small).size(); });
+    run("base64_decode_small", [&]() { sink += cparse::base64::decode(smallText).size(); });
+    run("base64_encode_1mb", [&]() { sink += cparse::base64::encode(large).size(); });
+    run("base64_decode_1mb", [&]() { sink += cparse::base64::decode(largeText).size(); });
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,410 @@
+#include <cparse/clientinterface.h>
+#include <cparse/exception.h>
+#include <igloo/igloo.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+#include "client.h"
+#include "fakeclient.h"
+#include "rangeserver.h"
+
+using namespace cparse;
+using namespace igloo;
+using namespace std;
+
+Context(ClientInterfaceTest)
+{
+    FakeClientInterface fake_;
+
+    string path_;
+
+    void TearDown()
+    {
+        if (!path_.empty())
+        {
+            unlink(path_.c_str());
+        }
+    }
+
+    // a local file to request with curl, so no server is needed
+    string writeTemp(const string &contents)
+    {
+        char name[] = "/tmp/cparse.test.XXXXXX";
+
+        int fd = mkstemp(name);
+
+        Assert::That(fd != -1, Equals(true));
+
+        Assert::That(write(fd, contents.data(), contents.size()), Equals((ssize_t) contents.size()));
+
+        close(fd);
+
+        path_ = name;
+
+        return "file://" + path_;
+    }
+
+    string readFile(const string &path)
+    {
+        ifstream in(path.c_str(), ios::binary);
+
+        return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+
+    Spec(sink_returning_false_aborts)
+    {
+        fake_.body = "response";
+
+        AssertThrows(Exception, fake_.request(http::GET, "http://test", Headers(), string(), [](const char * data, size_t size)
+        {
+            return false;
+        }));
+
+        Assert::That(LastException<Exception>().what(), Equals("response aborted"));
+    }
+
+    Spec(sink_throwing_aborts)
+    {
+        fake_.body = "response";
+
+        AssertThrows(Exception, fake_.request(http::GET, "http://test", Headers(), string(), [](const char * data, size_t size) -> bool
+        {
+            throw runtime_error("sink failed");
+        }));
+
+        Assert::That(LastException<Exception>().what(), Equals("response aborted"));
+    }
+
+    Spec(sink_receives_nul_bytes)
+    {
+        string received;
+
+        fake_.body = string("a\0b\0c", 5);
+
+        int code = fake_.request(http::GET, "http://test", Headers(), string(), [&received](const char * data, size_t size)
+        {
+            received.append(data, size);
+            return true;
+        });
+
+        Assert::That(code, Equals(200));
+
+        Assert::That(received, Equals(fake_.body));
+    }
+
+    Spec(curl_sink_receives_nul_bytes)
+    {
+        CURLClientInterface curl;
+        string body("a\0b\0c", 5);
+        string received;
+
+        string url = writeTemp(body);
+
+        curl.request(http::GET, url, Headers(), string(), [&received](const char * data, size_t size)
+        {
+            received.append(data, size);
+            return true;
+        });
+
+        Assert::That(received, Equals(body));
+    }
+
+    Spec(curl_sink_returning_false_aborts)
+    {
+        CURLClientInterface curl;
+
+        string url = writeTemp("response");
+
+        AssertThrows(Exception, curl.request(http::GET, url, Headers(), string(), [](const char * data, size_t size)
+        {
+            return false;
+        }));
+
+        Assert::That(LastException<Exception>().what(), Equals("response aborted"));
+    }
+
+    Spec(curl_sink_throwing_aborts)
+    {
+        CURLClientInterface curl;
+
+        string url = writeTemp("response");
+
+        AssertThrows(Exception, curl.request(http::GET, url, Headers(), string(), [](const char * data, size_t size) -> bool
+        {
+            throw runtime_error("sink failed");
+        }));
+
+        Assert::That(LastException<Exception>().what(), Equals("response aborted"));
+    }
+
+    Spec(source_is_buffered_by_default)
+    {
+        string body(3 * BUFSIZ + 5, 'x');
+        string response;
+        size_t offset = 0;
+
+        for (size_t i = 0; i < body.size(); i++)
+        {
+            body[i] = 'a' + (i % 26);
+        }
+
+        // hands out less than asked, so the body arrives in several parts
+        int code = fake_.request(http::POST, "http://test", Headers(), [&body, &offset](char * buffer, size_t size)
+        {
+            size_t len = std::min(std::min(size, (size_t) 100), body.size() - offset);
+
+            memcpy(buffer, body.data() + offset, len);
+
+            offset += len;
+
+            return len;
+        }, -1, response);
+
+        Assert::That(code, Equals(200));
+
+        Assert::That(fake_.requests, Equals(1));
+
+        Assert::That(fake_.method, Equals(http::POST));
+
+        Assert::That(fake_.size, Equals((ssize_t) -1));
+
+        Assert::That(fake_.data, Equals(body));
+    }
+
+    Spec(source_error_is_thrown)
+    {
+        string response;
+
+        AssertThrows(Exception, fake_.request(http::POST, "http://test", Headers(), [](char * buffer, size_t size) -> size_t
+        {
+            throw Exception("read failed");
+        }, 10, response));
+
+        Assert::That(LastException<Exception>().what(), Equals("read failed"));
+
+        Assert::That(fake_.requests, Equals(0));
+    }
+
+    Spec(download_reports_progress_by_default)
+    {
+        string received;
+        size_t calls = 0, last = 0, total = 1;
+
+        fake_.body = "downloaded";
+
+        int code = fake_.download("http://test/file", [&received](const char * data, size_t size)
+        {
+            received.append(data, size);
+            return true;
+        }, [&](size_t r, size_t t)
+        {
+            calls++;
+            last = r;
+            total = t;
+        });
+
+        Assert::That(code, Equals(200));
+
+        Assert::That(fake_.method, Equals(http::GET));
+
+        Assert::That(fake_.url, Equals("http://test/file"));
+
+        Assert::That(received, Equals(fake_.body));
+
+        Assert::That(calls > 0, Equals(true));
+
+        Assert::That(last, Equals(fake_.body.size()));
+
+        // the default doesn't know the size up front
+        Assert::That(total, Equals((size_t) 0));
+    }
+
+    Spec(download_without_progress)
+    {
+        string received;
+
+        fake_.body = "downloaded";
+
+        fake_.download("http://test/file", [&received](const char * data, size_t size)
+        {
+            received.append(data, size);
+            return true;
+        }, ProgressCallback());
+
+        Assert::That(received, Equals(fake_.body));
+    }
+
+    Spec(download_to_a_file_by_default)
+    {
+        string body(2 * BUFSIZ + 7, '\0');
+        size_t last = 0, total = 1;
+
+        for (size_t i = 0; i < body.size(); i++)
+        {
+            body[i] = i % 251;
+        }
+
+        fake_.body = body;
+
+        writeTemp("");
+
+        int fd = open(path_.c_str(), O_WRONLY);
+
+        Assert::That(fd != -1, Equals(true));
+
+        // the default ignores the connections and streams the whole url
+        int code = fake_.download("http://test/file", fd, 4, [&](size_t r, size_t t)
+        {
+            last = r;
+            total = t;
+        });
+
+        close(fd);
+
+        Assert::That(code, Equals(200));
+
+        Assert::That(fake_.requests, Equals(1));
+
+        Assert::That(readFile(path_), Equals(body));
+
+        Assert::That(last, Equals(body.size()));
+
+        Assert::That(total, Equals((size_t) 0));
+    }
+
+    Spec(download_to_a_file_aborts_on_a_write_error)
+    {
+        fake_.body = "downloaded";
+
+        writeTemp("");
+
+        // not open for writing, so every write fails
+        int fd = open(path_.c_str(), O_RDONLY);
+
+        Assert::That(fd != -1, Equals(true));
+
+        AssertThrows(Exception, fake_.download("http://test/file", fd, 1, ProgressCallback()));
+
+        close(fd);
+
+        Assert::That(LastException<Exception>().what(), Equals("response aborted"));
+    }
+
+    Spec(curl_download_to_a_file_without_ranges)
+    {
+        CURLClientInterface curl;
+        string body(1024 * 1024, '\0');
+        char name[] = "/tmp/cparse.test.XXXXXX";
+
+        for (size_t i = 0; i < body.size(); i++)
+        {
+            body[i] = (i * 7) % 256;
+        }
+
+        string url = writeTemp(body);
+
+        int fd = mkstemp(name);
+
+        Assert::That(fd != -1, Equals(true));
+
+        // file urls don't answer a HEAD with a status, so this falls back to a single stream
+        curl.download(url, fd, 4, ProgressCallback());
+
+        close(fd);
+
+        string received = readFile(name);
+
+        unlink(name);
+
+        Assert::That(received, Equals(body));
+    }
+
+    // large enough to be split between the connections
+    string rangeBody()
+    {
+        string body(4 * 1024 * 1024, '\0');
+
+        for (size_t i = 0; i < body.size(); i++)
+        {
+            body[i] = (i * 13) % 256;
+        }
+
+        return body;
+    }
+
+    Spec(curl_download_to_a_file_in_ranges)
+    {
+        CURLClientInterface curl;
+        RangeServer server(rangeBody(), true);
+        size_t last = 0, total = 0;
+
+        writeTemp("");
+
+        int fd = open(path_.c_str(), O_WRONLY);
+
+        Assert::That(fd != -1, Equals(true));
+
+        int code = curl.download(server.url(), fd, 4, [&](size_t r, size_t t)
+        {
+            last = r;
+            total = t;
+        });
+
+        close(fd);
+
+        Assert::That(code, Equals(200));
+
+        Assert::That(readFile(path_), Equals(server.body));
+
+        // the HEAD, then a range for each connection
+        Assert::That(server.requests.load(), Equals(5));
+
+        Assert::That(server.ranged.load(), Equals(4));
+
+        Assert::That(last, Equals(server.body.size()));
+
+        Assert::That(total, Equals(server.body.size()));
+    }
+
+    Spec(curl_download_to_a_file_when_ranges_are_ignored)
+    {
+        CURLClientInterface curl;
+        RangeServer server(rangeBody(), false);
+        size_t last = 1, total = 1;
+        bool reset = false;
+
+        writeTemp("");
+
+        int fd = open(path_.c_str(), O_WRONLY);
+
+        Assert::That(fd != -1, Equals(true));
+
+        int code = curl.download(server.url(), fd, 4, [&](size_t r, size_t t)
+        {
+            reset = reset || (r == 0 && t == 0);
+            last = r;
+            total = t;
+        });
+
+        close(fd);
+
+        Assert::That(code, Equals(200));
+
+        Assert::That(readFile(path_), Equals(server.body));
+
+        Assert::That(server.ranged.load() > 0, Equals(true));
+
+        // the HEAD, the ignored ranges, then the single stream starting over
+        Assert::That(server.requests.load(), Equals(server.ranged.load() + 2));
+
+        Assert::That(reset, Equals(true));
+
+        Assert::That(last, Equals(server.body.size()));
+
+        Assert::That(total, Equals(server.body.size()));
+    }
+};
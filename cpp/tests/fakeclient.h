@@ -0,0 +1,60 @@
+#ifndef CPARSE_TEST_FAKE_CLIENT_H_
+#define CPARSE_TEST_FAKE_CLIENT_H_
+
+#include <cparse/clientinterface.h>
+#include <cparse/exception.h>
+#include <string>
+
+using namespace std;
+
+// answers requests from memory and records what was sent, leaving the rest to the defaults
+class FakeClientInterface : public cparse::ClientInterface
+{
+public:
+    FakeClientInterface() : code(200), fail(false), requests(0), method(cparse::http::GET), size(0)
+    {}
+
+    using ClientInterface::request;
+
+    int request(cparse::http::method method, const string &url, const cparse::Headers &headers, const string &data, string &response)
+    {
+        requests++;
+
+        this->method = method;
+        this->url = url;
+        this->headers = headers;
+        this->data = data;
+
+        if (fail)
+        {
+            throw cparse::Exception("request failed");
+        }
+
+        response.append(body);
+
+        return code;
+    }
+
+    int request(cparse::http::method method, const string &url, const cparse::Headers &headers, const cparse::RequestSource &source,
+                ssize_t size, string &response)
+    {
+        this->size = size;
+
+        return ClientInterface::request(method, url, headers, source, size, response);
+    }
+
+    // the response
+    string body;
+    int code;
+    bool fail;
+
+    // the last request
+    int requests;
+    cparse::http::method method;
+    string url;
+    cparse::Headers headers;
+    string data;
+    ssize_t size;
+};
+
+#endif
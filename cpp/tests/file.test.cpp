@@ -0,0 +1,380 @@
+#include <cparse/parse.h>
+#include <cparse/type/file.h>
+#include <cparse/exception.h>
+#include <igloo/igloo.h>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+#include "client.h"
+#include "fakeclient.h"
+
+using namespace cparse;
+using namespace cparse::type;
+using namespace igloo;
+using namespace std;
+
+namespace cparse
+{
+    namespace type
+    {
+        string sniff_content_type(const char *data, size_t size);
+    }
+}
+
+Context(FileTest)
+{
+    FakeClientInterface *fake_;
+
+    string path_;
+
+    void SetUp()
+    {
+        fake_ = new FakeClientInterface();
+
+        Parse::set_client_interface(fake_);
+    }
+
+    void TearDown()
+    {
+        Parse::set_client_interface(new CURLClientInterface());
+
+        if (!path_.empty())
+        {
+            unlink(path_.c_str());
+        }
+    }
+
+    string writeTemp(const string &contents)
+    {
+        char name[] = "/tmp/cparse.test.XXXXXX";
+
+        int fd = mkstemp(name);
+
+        Assert::That(fd != -1, Equals(true));
+
+        Assert::That(write(fd, contents.data(), contents.size()), Equals((ssize_t) contents.size()));
+
+        close(fd);
+
+        path_ = name;
+
+        return path_;
+    }
+
+    string readFile(const string &path)
+    {
+        ifstream in(path.c_str(), ios::binary);
+
+        return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+
+    File remoteFile(const string &url)
+    {
+        JSON json;
+
+        json.set_string("name", "remote.txt");
+
+        json.set_string("url", url);
+
+        return File(json);
+    }
+
+    // answers a save like parse does
+    void answerSaved()
+    {
+        fake_->body = "{\"name\": \"saved.txt\", \"url\": \"http://files.test/saved.txt\"}";
+    }
+
+    string sniff(const string &data)
+    {
+        return sniff_content_type(data.data(), data.size());
+    }
+
+    Spec(save_sends_the_rest_of_a_regular_file)
+    {
+        string contents = "skipped the rest of the file";
+
+        int fd = open(writeTemp(contents).c_str(), O_RDONLY);
+
+        Assert::That(fd != -1, Equals(true));
+
+        lseek(fd, 8, SEEK_SET);
+
+        File file("test.txt", "", "text/plain");
+
+        answerSaved();
+
+        Assert::That(file.save(fd), Equals(true));
+
+        close(fd);
+
+        Assert::That(fake_->method, Equals(http::POST));
+
+        Assert::That(fake_->size, Equals((ssize_t) contents.size() - 8));
+
+        Assert::That(fake_->data, Equals(contents.substr(8)));
+
+        Assert::That(fake_->headers["Content-Type"], Equals("text/plain"));
+    }
+
+    Spec(save_sends_a_pipe_of_unknown_size)
+    {
+        string contents = "piped contents";
+        int fds[2];
+
+        Assert::That(pipe(fds), Equals(0));
+
+        Assert::That(write(fds[1], contents.data(), contents.size()), Equals((ssize_t) contents.size()));
+
+        close(fds[1]);
+
+        File file("test.txt", "", "text/plain");
+
+        answerSaved();
+
+        Assert::That(file.save(fds[0]), Equals(true));
+
+        close(fds[0]);
+
+        Assert::That(fake_->size, Equals((ssize_t) -1));
+
+        Assert::That(fake_->data, Equals(contents));
+    }
+
+    Spec(save_fails_on_a_read_error)
+    {
+        // reading a directory fails with EISDIR
+        int fd = open("/tmp", O_RDONLY);
+
+        Assert::That(fd != -1, Equals(true));
+
+        File file("test.txt", "", "text/plain");
+
+        Assert::That(file.save(fd), Equals(false));
+
+        close(fd);
+
+        Assert::That(fake_->requests, Equals(0));
+    }
+
+    Spec(download_streams_to_a_sink)
+    {
+        string received;
+        size_t last = 0;
+
+        fake_->body = "remote contents";
+
+        File file = remoteFile("http://files.test/remote.txt");
+
+        bool success = file.download([&received](const char * data, size_t size)
+        {
+            received.append(data, size);
+            return true;
+        }, [&last](size_t r, size_t t)
+        {
+            last = r;
+        });
+
+        Assert::That(success, Equals(true));
+
+        Assert::That(fake_->method, Equals(http::GET));
+
+        Assert::That(fake_->url, Equals("http://files.test/remote.txt"));
+
+        Assert::That(received, Equals(fake_->body));
+
+        Assert::That(last, Equals(fake_->body.size()));
+    }
+
+    Spec(download_fails_on_an_error_status)
+    {
+        fake_->code = 404;
+
+        File file = remoteFile("http://files.test/remote.txt");
+
+        Assert::That(file.download([](const char * data, size_t size)
+        {
+            return true;
+        }), Equals(false));
+    }
+
+    Spec(download_fails_without_a_url)
+    {
+        File file("test.txt", "contents", "text/plain");
+
+        Assert::That(file.download([](const char * data, size_t size)
+        {
+            return true;
+        }), Equals(false));
+
+        Assert::That(fake_->requests, Equals(0));
+    }
+
+    Spec(sniff_magic_numbers)
+    {
+        Assert::That(sniff(string("\x89PNG\r\n\x1a\n\0\0", 10)), Equals("image/png"));
+        Assert::That(sniff("\xff\xd8\xff\xe0"), Equals("image/jpeg"));
+        Assert::That(sniff("GIF87a"), Equals("image/gif"));
+        Assert::That(sniff("GIF89a"), Equals("image/gif"));
+        Assert::That(sniff("%PDF-1.4"), Equals("application/pdf"));
+        Assert::That(sniff("PK\x03\x04"), Equals("application/zip"));
+        Assert::That(sniff("\x1f\x8b\x08"), Equals("application/gzip"));
+        Assert::That(sniff("ID3\x03"), Equals("audio/mpeg"));
+        Assert::That(sniff("OggS"), Equals("audio/ogg"));
+        Assert::That(sniff("\x1a\x45\xdf\xa3"), Equals("video/webm"));
+    }
+
+    Spec(sniff_containers)
+    {
+        Assert::That(sniff(string("RIFF\0\0\0\0WEBPVP8 ", 16)), Equals("image/webp"));
+        Assert::That(sniff(string("RIFF\0\0\0\0WAVEfmt ", 16)), Equals("audio/wav"));
+        Assert::That(sniff(string("\0\0\0\x18" "ftypmp42", 12)), Equals("video/mp4"));
+
+        // too short to hold the container type
+        Assert::That(sniff("RIFF"), Equals("text/plain"));
+    }
+
+    Spec(sniff_text)
+    {
+        Assert::That(sniff("{\"key\": \"value\"}"), Equals("application/json"));
+        Assert::That(sniff("\n  [1, 2, 3]"), Equals("application/json"));
+        Assert::That(sniff("<!DOCTYPE html><html></html>"), Equals("text/html"));
+        Assert::That(sniff("<?xml version=\"1.0\"?><root/>"), Equals("application/xml"));
+        Assert::That(sniff("plain\ttext\r\n"), Equals("text/plain"));
+    }
+
+    Spec(sniff_binary)
+    {
+        Assert::That(sniff(string("text\0with a nul", 15)), Equals("application/octet-stream"));
+        Assert::That(sniff("\x01\x02\x03"), Equals("application/octet-stream"));
+        Assert::That(sniff(""), Equals("application/octet-stream"));
+        Assert::That(sniff_content_type(NULL, 0), Equals("application/octet-stream"));
+    }
+
+    Spec(from_path_missing)
+    {
+        AssertThrows(Exception, File::fromPath("/tmp/cparse.test.missing"));
+
+        Assert::That(LastException<Exception>().what(), Equals("/tmp/cparse.test.missing: No such file or directory"));
+    }
+
+    Spec(from_path_directory)
+    {
+        AssertThrows(Exception, File::fromPath("/tmp"));
+
+        Assert::That(LastException<Exception>().what(), Equals("/tmp: not a regular file"));
+    }
+
+    Spec(from_path_maps_the_contents)
+    {
+        string contents = "{\"mapped\": true}";
+
+        string path = writeTemp(contents);
+
+        File file = File::fromPath(path);
+
+        Assert::That(file.getContents(), Equals(contents));
+
+        Assert::That(file.getContentType(), Equals("application/json"));
+
+        Assert::That(file.getLocaleFileName(), Equals(path.substr(path.rfind('/') + 1)));
+
+        Assert::That(File::fromPath(path, "text/plain").getContentType(), Equals("text/plain"));
+    }
+
+    Spec(from_path_mapping_survives_a_copy)
+    {
+        string contents = "outlives the original";
+
+        File copy;
+
+        {
+            File file = File::fromPath(writeTemp(contents));
+
+            copy = file;
+        }
+
+        File moved(std::move(copy));
+
+        Assert::That(moved.getContents(), Equals(contents));
+
+        Assert::That(copy.getContents(), Equals(""));
+    }
+
+    Spec(from_path_empty_file)
+    {
+        File file = File::fromPath(writeTemp(""));
+
+        Assert::That(file.getContents(), Equals(""));
+
+        Assert::That(file.getContentType(), Equals("application/octet-stream"));
+    }
+
+    Spec(save_sends_the_mapping)
+    {
+        string contents = "mapped contents";
+
+        File file = File::fromPath(writeTemp(contents));
+
+        answerSaved();
+
+        Assert::That(file.save(), Equals(true));
+
+        Assert::That(fake_->data, Equals(contents));
+
+        Assert::That(fake_->headers["Content-Type"], Equals("text/plain"));
+    }
+
+    Spec(set_contents_replaces_the_mapping)
+    {
+        File file = File::fromPath(writeTemp("mapped contents"));
+
+        file.setContents("in memory");
+
+        Assert::That(file.getContents(), Equals("in memory"));
+    }
+
+    Spec(download_to_a_path)
+    {
+        fake_->body = "remote contents";
+
+        string path = writeTemp("older and longer contents");
+
+        File file = remoteFile("http://files.test/remote.txt");
+
+        Assert::That(file.download(path), Equals(true));
+
+        Assert::That(fake_->url, Equals("http://files.test/remote.txt"));
+
+        Assert::That(readFile(path), Equals(fake_->body));
+    }
+
+    Spec(download_to_a_path_removes_it_on_failure)
+    {
+        fake_->fail = true;
+
+        string path = writeTemp("older contents");
+
+        File file = remoteFile("http://files.test/remote.txt");
+
+        Assert::That(file.download(path), Equals(false));
+
+        Assert::That(access(path.c_str(), F_OK), Equals(-1));
+    }
+
+    Spec(download_to_a_path_removes_it_on_an_error_status)
+    {
+        fake_->code = 404;
+        fake_->body = "not found";
+
+        string path = writeTemp("");
+
+        File file = remoteFile("http://files.test/remote.txt");
+
+        Assert::That(file.download(path), Equals(false));
+
+        Assert::That(access(path.c_str(), F_OK), Equals(-1));
+    }
+};
@@ -1,6 +1,9 @@
 #include <cparse/parse.h>
 #include <cparse/object.h>
+#include <cparse/user.h>
 #include <cparse/exception.h>
+#include <cparse/asyncclient.h>
+#include <cparse/type/date.h>
 #include <igloo/igloo.h>
 #include <typeinfo>
 
@@ -11,6 +14,8 @@ using namespace std;
 namespace cparse
 {
     bool validate_class_name(const string &value);
+
+    time_t datetime(const string &s);
 }
 
 
@@ -55,6 +60,15 @@ Context(ObjectTest)
         Assert::That(true, Equals(value));
     }
 
+    Spec(datetimeBeforeEpoch)
+    {
+        Assert::That(datetime("2011-08-20T02:06:57.931Z"), Equals((time_t) 1313806017));
+
+        Assert::That(datetime("1969-12-31T23:59:59.500Z"), Equals((time_t) -1));
+
+        Assert::That(type::Date(string("1969-12-31T23:59:59.500Z")).getTimestamp(), Equals((time_t) -1));
+    }
+
     Spec(get)
     {
         AssertThrows(cparse::Exception, obj_->get("testVal1"));
@@ -108,6 +122,48 @@ Context(ObjectTest)
         Assert::That(backgroundSuccess_, Equals(true));
     }
 
+    Spec(saveAsync)
+    {
+        obj_->setInt("score", 7890);
+
+        obj_->setString("status", "saved async");
+
+        std::future<bool> saved = obj_->saveAsync();
+
+        Assert::That(saved.get(), Equals(true));
+
+        Assert::That(obj_->is_valid(), Equals(true));
+    }
+
+    Spec(deleteAsync)
+    {
+        Object obj2("TestCase");
+
+        Assert::That(obj2.saveAsync().get(), Equals(true));
+
+        Assert::That(obj2.deleteAsync().get(), Equals(true));
+    }
+
+    Spec(saveWithAsyncClient)
+    {
+        obj_->setInt("score", 2468);
+
+        Assert::That(obj_->save(AsyncClient::shared()).get(), Equals(true));
+
+        Assert::That(obj_->is_valid(), Equals(true));
+
+        Assert::That(obj_->refresh(AsyncClient::shared()).get(), Equals(true));
+
+        Assert::That(obj_->getInt("score"), Equals(2468));
+    }
+
+    Spec(saveAllAsync)
+    {
+        std::vector<Object> objects(3, Object("TestCase"));
+
+        Assert::That(Object::saveAllAsync(objects).get(), Equals(true));
+    }
+
 
     Spec(setInt)
     {
@@ -175,6 +231,78 @@ Context(ObjectTest)
         delete fetched;
     }
 
+    Spec(copyFetched)
+    {
+        MySubclass sub;
+
+        sub.setInt("val1", 1);
+
+        obj_->setObject("sub", sub);
+
+        Object copy(*obj_);
+
+        const Object &original = *obj_, &copied = copy;
+
+        Assert::That(copied.getObject("sub") == original.getObject("sub"), Equals(true));
+
+        copy.getObject("sub")->setInt("val1", 2);
+
+        Assert::That(copied.getObject("sub") == original.getObject("sub"), Equals(false));
+
+        Assert::That(obj_->getObject("sub")->getInt("val1"), Equals(1));
+
+        Assert::That(copy.getObject("sub")->getInt("val1"), Equals(2));
+
+        obj_->setObject("owner", sub);
+
+        Object userCopy(*obj_);
+
+        const Object &owned = userCopy;
+
+        // getUser copies on write like getObject, so the copy gets its own
+        Object *owner = userCopy.getUser("owner");
+
+        Assert::That(owner == userCopy.getObject("owner"), Equals(true));
+
+        Assert::That(owned.getObject("owner") == original.getObject("owner"), Equals(false));
+
+        AssertThrows(cparse::Exception, obj_->getUser("missing"));
+
+        Assert::That(obj_->contains("missing"), Equals(false));
+    }
+
+    Spec(copyAfterGetObject)
+    {
+        MySubclass sub;
+
+        sub.setInt("val1", 1);
+
+        obj_->setObject("sub", sub);
+
+        // a pointer for changes is handed out before the copy
+        Object *fetched = obj_->getObject("sub");
+
+        Object copy(*obj_);
+
+        fetched->setInt("val1", 2);
+
+        const Object &copied = copy;
+
+        Assert::That(copied.getObject("sub")->getInt("val1"), Equals(1));
+
+        Assert::That(obj_->getObject("sub") == fetched, Equals(true));
+
+        Assert::That(obj_->getObject("sub")->getInt("val1"), Equals(2));
+
+        Object assigned("TestCase");
+
+        assigned = *obj_;
+
+        fetched->setInt("val1", 3);
+
+        Assert::That(assigned.getObject("sub")->getInt("val1"), Equals(2));
+    }
+
     Spec(equality)
     {
         Object obj2("TestCase");
@@ -0,0 +1,172 @@
+#ifndef CPARSE_TEST_RANGE_SERVER_H_
+#define CPARSE_TEST_RANGE_SERVER_H_
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+
+// serves a body over http on a local port, one connection at a time. ranges are always advertised,
+// but only honoured when asked to, like a server behind a proxy that drops them
+class RangeServer
+{
+public:
+    RangeServer(const string &body, bool honourRanges) : body(body), honourRanges(honourRanges), requests(0), ranged(0), port(0)
+    {
+        struct sockaddr_in addr;
+        socklen_t len = sizeof(addr);
+
+        memset(&addr, 0, sizeof(addr));
+
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        // an ephemeral port, so nothing else is listening on it
+        fd_ = socket(AF_INET, SOCK_STREAM, 0);
+
+        if (fd_ == -1 || bind(fd_, (struct sockaddr *) &addr, sizeof(addr)) == -1 || listen(fd_, 16) == -1 ||
+                getsockname(fd_, (struct sockaddr *) &addr, &len) == -1)
+        {
+            throw runtime_error(strerror(errno));
+        }
+
+        port = ntohs(addr.sin_port);
+
+        thread_ = thread(&RangeServer::serve, this);
+    }
+
+    ~RangeServer()
+    {
+        // wakes the accept
+        shutdown(fd_, SHUT_RDWR);
+
+        thread_.join();
+
+        close(fd_);
+    }
+
+    string url() const
+    {
+        return "http://127.0.0.1:" + to_string(port) + "/file";
+    }
+
+    const string body;
+    const bool honourRanges;
+    // every request, and the ones asking for a range
+    atomic<int> requests;
+    atomic<int> ranged;
+    int port;
+
+private:
+    void serve()
+    {
+        int client;
+
+        while ((client = accept(fd_, NULL, NULL)) != -1)
+        {
+            respond(client);
+
+            close(client);
+        }
+    }
+
+    void respond(int client)
+    {
+        static const char RANGE[] = "\r\nRange: bytes=";
+
+        string request;
+        char buf[BUFSIZ];
+        size_t start = 0, end = body.size() - 1;
+        bool partial = false;
+
+        while (request.find("\r\n\r\n") == string::npos)
+        {
+            ssize_t count = recv(client, buf, sizeof(buf), 0);
+
+            if (count <= 0)
+            {
+                return;
+            }
+
+            request.append(buf, count);
+        }
+
+        requests++;
+
+        const char *range = strcasestr(request.c_str(), RANGE);
+
+        if (range != NULL)
+        {
+            ranged++;
+
+            if (honourRanges)
+            {
+                char *next = NULL;
+
+                start = strtoull(range + sizeof(RANGE) - 1, &next, 10);
+
+                end = strtoull(next + 1, NULL, 10);
+
+                partial = true;
+            }
+        }
+
+        string headers = partial ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n";
+
+        headers += "Accept-Ranges: bytes\r\nConnection: close\r\n";
+
+        headers += "Content-Length: " + to_string(end - start + 1) + "\r\n";
+
+        if (partial)
+        {
+            headers += "Content-Range: bytes " + to_string(start) + "-" + to_string(end) + "/" + to_string(body.size()) + "\r\n";
+        }
+
+        headers += "\r\n";
+
+        if (!sendAll(client, headers.data(), headers.size()) || !request.compare(0, 5, "HEAD "))
+        {
+            return;
+        }
+
+        sendAll(client, body.data() + start, end - start + 1);
+    }
+
+    // the client may hang up on a response it doesn't want, so without a SIGPIPE
+    static bool sendAll(int client, const char *data, size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t count = send(client, data, size, MSG_NOSIGNAL);
+
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+
+            if (count <= 0)
+            {
+                return false;
+            }
+
+            data += count;
+            size -= count;
+        }
+
+        return true;
+    }
+
+    int fd_;
+    thread thread_;
+};
+
+#endif
@@ -0,0 +1,333 @@
+#include "base64.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CPARSE_BASE64_X86 1
+#include <immintrin.h>
+#endif
+
+static const char cparse_base64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* the value of each character, or 0xff if it is not base64 */
+static const unsigned char cparse_base64_values[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+/* encodes whole blocks, returns the number of bytes encoded */
+typedef size_t (*cParseBase64Encoder)(char *out, const unsigned char *in, size_t size);
+
+/* decodes whole blocks up to the first invalid one, returns the number of characters decoded */
+typedef size_t (*cParseBase64Decoder)(unsigned char *out, const char *in, size_t length);
+
+static size_t cparse_base64_encode_none(char *out, const unsigned char *in, size_t size)
+{
+    return 0;
+}
+
+static size_t cparse_base64_decode_none(unsigned char *out, const char *in, size_t length)
+{
+    return 0;
+}
+
+#ifdef CPARSE_BASE64_X86
+
+/*
+ * The vector versions follow the algorithms of Wojciech Mula and Daniel Lemire,
+ * see http://0x80.pl/notesen/2016-01-12-sse-base64-encoding.html
+ */
+
+__attribute__((target("ssse3")))
+static size_t cparse_base64_encode_ssse3(char *out, const unsigned char *in, size_t size)
+{
+    const __m128i shuffle = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const __m128i offsets = _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+    size_t done = 0;
+
+    /* reads 16 bytes for every 12 encoded */
+    for (; size - done >= 16; done += 12, out += 16) {
+        __m128i str = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in + done)), shuffle);
+
+        /* split each 3 bytes into 4 six bit values */
+        __m128i hi = _mm_mulhi_epu16(_mm_and_si128(str, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        __m128i lo = _mm_mullo_epi16(_mm_and_si128(str, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        __m128i values = _mm_or_si128(hi, lo);
+
+        /* map the values to the alphabet by range */
+        __m128i ranges = _mm_subs_epu8(values, _mm_set1_epi8(51));
+
+        ranges = _mm_sub_epi8(ranges, _mm_cmpgt_epi8(values, _mm_set1_epi8(25)));
+
+        _mm_storeu_si128((__m128i *)out, _mm_add_epi8(values, _mm_shuffle_epi8(offsets, ranges)));
+    }
+
+    return done;
+}
+
+__attribute__((target("avx2")))
+static size_t cparse_base64_encode_avx2(char *out, const unsigned char *in, size_t size)
+{
+    const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const __m256i offsets = _mm256_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0,
+                            65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+    size_t done = 0;
+
+    /* reads 28 bytes for every 24 encoded, 12 in each lane */
+    for (; size - done >= 32; done += 24, out += 32) {
+        __m128i first = _mm_loadu_si128((const __m128i *)(in + done));
+        __m128i second = _mm_loadu_si128((const __m128i *)(in + done + 12));
+        __m256i str = _mm256_inserti128_si256(_mm256_castsi128_si256(first), second, 1);
+
+        str = _mm256_shuffle_epi8(str, shuffle);
+
+        __m256i hi = _mm256_mulhi_epu16(_mm256_and_si256(str, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+        __m256i lo = _mm256_mullo_epi16(_mm256_and_si256(str, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+        __m256i values = _mm256_or_si256(hi, lo);
+
+        __m256i ranges = _mm256_subs_epu8(values, _mm256_set1_epi8(51));
+
+        ranges = _mm256_sub_epi8(ranges, _mm256_cmpgt_epi8(values, _mm256_set1_epi8(25)));
+
+        _mm256_storeu_si256((__m256i *)out, _mm256_add_epi8(values, _mm256_shuffle_epi8(offsets, ranges)));
+    }
+
+    return done;
+}
+
+__attribute__((target("ssse3")))
+static size_t cparse_base64_decode_ssse3(unsigned char *out, const char *in, size_t length)
+{
+    const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask_2f = _mm_set1_epi8(0x2f);
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    size_t done = 0;
+
+    /* writes 16 bytes for every 12 decoded, so stop while there is room */
+    for (; length - done >= 24; done += 16, out += 12) {
+        __m128i str = _mm_loadu_si128((const __m128i *)(in + done));
+        __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask_2f);
+        __m128i lo_nibbles = _mm_and_si128(str, mask_2f);
+        __m128i invalid = _mm_and_si128(_mm_shuffle_epi8(lut_lo, lo_nibbles), _mm_shuffle_epi8(lut_hi, hi_nibbles));
+
+        /* leave invalid characters for the scalar version to report */
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(invalid, _mm_setzero_si128())) != 0xFFFF) {
+            break;
+        }
+
+        __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(_mm_cmpeq_epi8(str, mask_2f), hi_nibbles));
+
+        str = _mm_add_epi8(str, roll);
+
+        /* pack each 4 six bit values into 3 bytes */
+        str = _mm_maddubs_epi16(str, _mm_set1_epi32(0x01400140));
+        str = _mm_madd_epi16(str, _mm_set1_epi32(0x00011000));
+
+        _mm_storeu_si128((__m128i *)out, _mm_shuffle_epi8(str, pack));
+    }
+
+    return done;
+}
+
+__attribute__((target("avx2")))
+static size_t cparse_base64_decode_avx2(unsigned char *out, const char *in, size_t length)
+{
+    const __m256i lut_lo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+                                            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m256i lut_hi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i lut_roll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                             0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask_2f = _mm256_set1_epi8(0x2f);
+    const __m256i pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                          2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+    size_t done = 0;
+
+    /* writes 32 bytes for every 24 decoded */
+    for (; length - done >= 48; done += 32, out += 24) {
+        __m256i str = _mm256_loadu_si256((const __m256i *)(in + done));
+        __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask_2f);
+        __m256i lo_nibbles = _mm256_and_si256(str, mask_2f);
+
+        if (!_mm256_testz_si256(_mm256_shuffle_epi8(lut_lo, lo_nibbles), _mm256_shuffle_epi8(lut_hi, hi_nibbles))) {
+            break;
+        }
+
+        __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(_mm256_cmpeq_epi8(str, mask_2f), hi_nibbles));
+
+        str = _mm256_add_epi8(str, roll);
+
+        str = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+        str = _mm256_madd_epi16(str, _mm256_set1_epi32(0x00011000));
+        str = _mm256_shuffle_epi8(str, pack);
+
+        _mm256_storeu_si256((__m256i *)out, _mm256_permutevar8x32_epi32(str, lanes));
+    }
+
+    return done;
+}
+
+#endif
+
+static cParseBase64Encoder cparse_base64_encoder = NULL;
+
+static cParseBase64Decoder cparse_base64_decoder = NULL;
+
+/* picks the fastest versions the processor supports, once */
+static void cparse_base64_dispatch()
+{
+    cParseBase64Encoder encoder = cparse_base64_encode_none;
+    cParseBase64Decoder decoder = cparse_base64_decode_none;
+
+#ifdef CPARSE_BASE64_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+        encoder = cparse_base64_encode_avx2;
+        decoder = cparse_base64_decode_avx2;
+    } else if (__builtin_cpu_supports("ssse3")) {
+        encoder = cparse_base64_encode_ssse3;
+        decoder = cparse_base64_decode_ssse3;
+    }
+#endif
+
+    __atomic_store_n(&cparse_base64_encoder, encoder, __ATOMIC_RELAXED);
+    __atomic_store_n(&cparse_base64_decoder, decoder, __ATOMIC_RELAXED);
+}
+
+size_t cparse_base64_encoded_size(size_t size)
+{
+    return size / 3 * 4 + (size % 3 ? 4 : 0);
+}
+
+size_t cparse_base64_decoded_size(size_t length)
+{
+    return length / 4 * 3 + (length % 4 ? 3 : 0);
+}
+
+size_t cparse_base64_encode(char *out, const void *data, size_t size)
+{
+    const unsigned char *in = data;
+    cParseBase64Encoder encoder = __atomic_load_n(&cparse_base64_encoder, __ATOMIC_RELAXED);
+    char *start = out;
+    size_t done = 0;
+
+    if (encoder == NULL) {
+        cparse_base64_dispatch();
+        encoder = __atomic_load_n(&cparse_base64_encoder, __ATOMIC_RELAXED);
+    }
+
+    done = encoder(out, in, size);
+
+    in += done;
+    size -= done;
+    out += done / 3 * 4;
+
+    for (; size >= 3; size -= 3, in += 3) {
+        *out++ = cparse_base64_alphabet[in[0] >> 2];
+        *out++ = cparse_base64_alphabet[((in[0] & 0x03) << 4) | (in[1] >> 4)];
+        *out++ = cparse_base64_alphabet[((in[1] & 0x0f) << 2) | (in[2] >> 6)];
+        *out++ = cparse_base64_alphabet[in[2] & 0x3f];
+    }
+
+    if (size > 0) {
+        *out++ = cparse_base64_alphabet[in[0] >> 2];
+
+        if (size == 1) {
+            *out++ = cparse_base64_alphabet[(in[0] & 0x03) << 4];
+            *out++ = '=';
+        } else {
+            *out++ = cparse_base64_alphabet[((in[0] & 0x03) << 4) | (in[1] >> 4)];
+            *out++ = cparse_base64_alphabet[(in[1] & 0x0f) << 2];
+        }
+        *out++ = '=';
+    }
+
+    return out - start;
+}
+
+int cparse_base64_decode(void *out, const char *str, size_t length, size_t *size)
+{
+    const unsigned char *in = (const unsigned char *)str;
+    cParseBase64Decoder decoder = __atomic_load_n(&cparse_base64_decoder, __ATOMIC_RELAXED);
+    unsigned char *dst = out;
+    unsigned a, b, c, d;
+    size_t done = 0;
+
+    if (decoder == NULL) {
+        cparse_base64_dispatch();
+        decoder = __atomic_load_n(&cparse_base64_decoder, __ATOMIC_RELAXED);
+    }
+
+    /* the padding only completes the last block */
+    if (length > 0 && in[length - 1] == '=') {
+        length--;
+
+        if (length > 0 && in[length - 1] == '=') {
+            length--;
+        }
+    }
+
+    if (length % 4 == 1) {
+        return 0;
+    }
+
+    done = decoder(dst, str, length);
+
+    in += done;
+    length -= done;
+    dst += done / 4 * 3;
+
+    for (; length >= 4; length -= 4, in += 4) {
+        a = cparse_base64_values[in[0]];
+        b = cparse_base64_values[in[1]];
+        c = cparse_base64_values[in[2]];
+        d = cparse_base64_values[in[3]];
+
+        if ((a | b | c | d) & 0x80) {
+            return 0;
+        }
+
+        *dst++ = (unsigned char)((a << 2) | (b >> 4));
+        *dst++ = (unsigned char)((b << 4) | (c >> 2));
+        *dst++ = (unsigned char)((c << 6) | d);
+    }
+
+    if (length > 0) {
+        a = cparse_base64_values[in[0]];
+        b = cparse_base64_values[in[1]];
+        c = length > 2 ? cparse_base64_values[in[2]] : 0;
+
+        if ((a | b | c) & 0x80) {
+            return 0;
+        }
+
+        *dst++ = (unsigned char)((a << 2) | (b >> 4));
+
+        if (length > 2) {
+            *dst++ = (unsigned char)((b << 4) | (c >> 2));
+        }
+    }
+
+    if (size != NULL) {
+        *size = dst - (unsigned char *)out;
+    }
+
+    return 1;
+}
@@ -0,0 +1,45 @@
+#ifndef CPARSE_BASE64_H_
+#define CPARSE_BASE64_H_
+
+/*
+ * This header is shared with the C++ library, so it only depends on the C standard library.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! the number of characters needed to encode data, not counting a terminating NUL
+ * \param size the number of bytes to encode
+ */
+size_t cparse_base64_encoded_size(size_t size);
+
+/*! the most bytes a base64 string can decode to
+ * \param length the number of characters in the string
+ */
+size_t cparse_base64_decoded_size(size_t length);
+
+/*! encodes data as padded base64, using SIMD instructions when the processor has them
+ * \param out the output of at least cparse_base64_encoded_size(size) characters. It is not NUL terminated.
+ * \param data the bytes to encode
+ * \param size the number of bytes
+ * \returns the number of characters written
+ */
+size_t cparse_base64_encode(char *out, const void *data, size_t size);
+
+/*! decodes base64, with or without padding, using SIMD instructions when the processor has them
+ * \param out the output of at least cparse_base64_decoded_size(length) bytes
+ * \param str the characters to decode
+ * \param length the number of characters
+ * \param size set to the number of bytes written
+ * \returns non-zero if the string was valid base64
+ */
+int cparse_base64_decode(void *out, const char *str, size_t length, size_t *size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
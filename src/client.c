@@ -8,38 +8,55 @@
 #include <errno.h>
 #include <curl/curl.h>
 #include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
 #include <json.h>
 #include <cparse/json.h>
 #include <cparse/object.h>
 #include <cparse/error.h>
 #include <cparse/util.h>
+#include <cparse/memory.h>
 #include "client.h"
 #include "protocol.h"
 #include "private.h"
 #include "request.h"
 #include "data_list.h"
 #include "log.h"
+#include "metrics.h"
 
-/*! the base domain for Parse requests
- * TODO: make this configurable
+/*! the base domain for Parse requests, unless set with cparse_set_server_url()
  */
 const char *const cparse_domain = "https://api.parse.com";
 
+extern const char *cparse_server_url;
+
 extern const char *const cparse_lib_version;
 
 extern const char *cparse_api_key;
 
 extern const char *cparse_app_id;
 
+extern cParseTraceHooks cparse_trace_hooks;
+
+extern const char *cparse_correlation_header;
+
+extern int cparse_request_retries;
+
 const char *const cParseHttpRequestMethodNames[] = {"GET", "POST", "PUT", "DELETE"};
 
 /*! the global client instance
  */
 cParseClient *cparse_this_client = NULL;
 
+/* for assigning request ids */
+static unsigned long cparse_client_request_count = 0;
+
+/* if curl was initialized to use the library allocator */
+static bool cparse_curl_initialized = false;
+
 cParseClient *cparse_client_new()
 {
-    cParseClient *client = malloc(sizeof(cParseClient));
+    cParseClient *client = cparse_malloc(sizeof(cParseClient));
 
     if (client == NULL) {
         cparse_log_errno(ENOMEM);
@@ -74,7 +91,7 @@ cParseClient *cparse_client_with_version(const char *apiVersion)
         return NULL;
     }
 
-    client->apiVersion = strdup(apiVersion);
+    client->apiVersion = cparse_strdup(apiVersion);
 
     return client;
 }
@@ -94,7 +111,7 @@ void cparse_client_free(cParseClient *client)
     pthread_mutex_destroy(&client->lock);
 
     if (client->apiVersion) {
-        free(client->apiVersion);
+        cparse_free(client->apiVersion);
     }
 
     if (client->headers) {
@@ -102,16 +119,17 @@ void cparse_client_free(cParseClient *client)
     }
 
     if (client->sessionToken) {
-        free(client->sessionToken);
+        cparse_free(client->sessionToken);
     }
 
-    free(client);
+    cparse_free(client);
 }
 
 
 static bool cparse_curl_slist_append(struct curl_slist **list, const char *format, ...)
 {
     char buf[CPARSE_BUF_SIZE + 1] = {0};
+    struct curl_slist *appended = NULL;
     va_list args;
     int rval = 0;
 
@@ -124,13 +142,16 @@ static bool cparse_curl_slist_append(struct curl_slist **list, const char *forma
         return false;
     }
 
-    *list = curl_slist_append(*list, buf);
+    /* on failure curl returns NULL and leaves the list alone */
+    appended = curl_slist_append(*list, buf);
 
-    if (list == NULL) {
-        /* TODO: log some error? curl doesn't say what happened */
+    if (appended == NULL) {
+        cparse_log_errno(ENOMEM);
         return false;
     }
 
+    *list = appended;
+
     return true;
 }
 
@@ -178,6 +199,12 @@ cParseClient *cparse_get_client()
         return NULL;
     }
 
+    if (!cparse_curl_initialized) {
+        /* does nothing if the application has already initialized curl */
+        cparse_curl_initialized = curl_global_init_mem(CURL_GLOBAL_ALL, cparse_malloc, cparse_free, cparse_realloc, cparse_strdup,
+                                                       cparse_calloc) == CURLE_OK;
+    }
+
     if (client->cURL == NULL) {
         pthread_mutex_lock(&client->lock);
         client->cURL = curl_easy_init();
@@ -206,6 +233,11 @@ void cparse_free_client()
         cparse_client_free(cparse_this_client);
         cparse_this_client = NULL;
     }
+
+    if (cparse_curl_initialized) {
+        curl_global_cleanup();
+        cparse_curl_initialized = false;
+    }
 }
 
 void cparse_client_set_session_token(const char *token)
@@ -214,7 +246,7 @@ void cparse_client_set_session_token(const char *token)
         if (token != NULL) {
             cparse_replace_str(&cparse_this_client->sessionToken, token);
         } else if (cparse_this_client->sessionToken != NULL) {
-            free(cparse_this_client->sessionToken);
+            cparse_free(cparse_this_client->sessionToken);
             cparse_this_client->sessionToken = NULL;
         }
     }
@@ -229,49 +261,67 @@ const char *cparse_client_get_session_token()
     return NULL;
 }
 
+/* seconds on a clock that only goes forward */
+static double cparse_client_now()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/* calls a trace hook with the state of a request */
+static void cparse_client_trace(cParseTraceCallback callback, cParseRequest *request, const char *error)
+{
+    cParseTraceEvent event;
+
+    if (callback == NULL) {
+        return;
+    }
+
+    event.requestId = request->id;
+    event.correlationId = request->correlationId[0] ? request->correlationId : NULL;
+    event.method = cParseHttpRequestMethodNames[request->method];
+    event.path = request->path;
+    event.attempt = request->attempt;
+    event.elapsed = cparse_client_now() - request->enqueued;
+    event.status = request->response.code;
+    event.error = error;
+
+    callback(&event, cparse_trace_hooks.param);
+}
+
 static size_t cparse_client_get_response(void *ptr, size_t size, size_t nmemb, void *data)
 {
-    cParseResponse *s = NULL;
-    size_t new_len = 0;
+    cParseRequest *request = (cParseRequest *)data;
 
-    if (data == NULL || ptr == NULL) {
+    if (request == NULL || ptr == NULL) {
         cparse_log_errno(EINVAL);
         return 0;
     }
 
-    s = (cParseResponse *)data;
-
-    new_len = s->size + size * nmemb;
+    if (!request->receiving) {
+        request->receiving = true;
+        cparse_client_trace(cparse_trace_hooks.onFirstByte, request, NULL);
+    }
 
-    s->text = realloc(s->text, new_len + 1);
-    if (s->text == NULL) {
-        cparse_log_errno(ENOMEM);
+    if (!cparse_response_append(&request->response, ptr, size * nmemb)) {
         return 0;
     }
-    memcpy(s->text + s->size, ptr, size * nmemb);
-    s->text[new_len] = '\0';
-    s->size = new_len;
 
     return size * nmemb;
 }
 
-static bool cparse_request_append_body(cParseRequest *request, const char *value)
+/* appends a string to the request body */
+static bool cparse_request_append_str(cParseRequest *request, const char *value)
 {
-    size_t size = 0;
-
     if (!request || !value) {
         cparse_log_errno(EINVAL);
         return false;
     }
 
-    size = strlen(value);
-
-    if (!cparse_str_append(&request->body, value, size)) {
-        return false;
-    }
-
-    request->bodySize += size;
-    return true;
+    return cparse_request_append_body(request, value, strlen(value));
 }
 
 
@@ -283,27 +333,27 @@ static bool cparse_request_append_data(cParseRequest *request, const char *key,
     }
 
     if (key == NULL) {
-        if (!cparse_request_append_body(request, value)) {
+        if (!cparse_request_append_str(request, value)) {
             return false;
         }
 
     } else {
         /* append &key=value */
         if (!cparse_str_empty(request->body)) {
-            if (!cparse_request_append_body(request, "&")) {
+            if (!cparse_request_append_body(request, "&", 1)) {
                 return false;
             }
         }
 
-        if (!cparse_request_append_body(request, key)) {
+        if (!cparse_request_append_str(request, key)) {
             return false;
         }
 
-        if (!cparse_request_append_body(request, "=")) {
+        if (!cparse_request_append_body(request, "=", 1)) {
             return false;
         }
 
-        if (!cparse_request_append_body(request, value)) {
+        if (!cparse_request_append_str(request, value)) {
             return false;
         }
     }
@@ -313,23 +363,23 @@ static bool cparse_request_append_data(cParseRequest *request, const char *key,
 
 static bool cparse_request_build_body(cParseClient *client, cParseRequest *request, bool encode)
 {
-    cParseRequestData *data = NULL;
+    size_t i;
 
     if (!client || !request) {
         cparse_log_errno(EINVAL);
         return false;
     }
 
-    for (data = request->data; data; data = data->next) {
-        char *encoded = encode ? curl_easy_escape(client->cURL, data->value, 0) : NULL;
+    for (i = 0; i < cparse_dlist_size(&request->data); i++) {
+        const char *value = cparse_dlist_value(&request->data, i);
+        char *encoded = encode ? curl_easy_escape(client->cURL, value, 0) : NULL;
 
-        if (!cparse_request_append_data(request, data->key, encoded ? encoded : data->value)) {
+        if (!cparse_request_append_data(request, cparse_dlist_key(&request->data, i), encoded ? encoded : value)) {
+            curl_free(encoded);
             return false;
         }
 
-        if (encoded) {
-            free(encoded);
-        }
+        curl_free(encoded);
     }
 
     return true;
@@ -343,18 +393,25 @@ static bool cparse_client_set_request_url(cParseClient *client, cParseRequest *r
         cparse_log_errno(EINVAL);
         return false;
     }
+
+    /* the body is rebuilt for each attempt */
+    if (request->body) {
+        request->body[0] = 0;
+    }
+    request->bodySize = 0;
+
     /*
      * Maximum length of a URI doesn't not seem to be standard.
      * Going with a dynamic string.
      */
-    if (!cparse_build_string(&buf, cparse_domain, "/", client->apiVersion, "/", request->path, NULL)) {
+    if (!cparse_build_string(&buf, cparse_server_url ? cparse_server_url : cparse_domain, "/", client->apiVersion, "/", request->path, NULL)) {
         return false;
     }
 
-    if (request->data) {
+    if (cparse_dlist_size(&request->data) > 0) {
         if (request->method == cParseHttpRequestMethodGet) {
-            if (!cparse_request_build_body(client->cURL, request, true)) {
-                free(buf);
+            if (!cparse_request_build_body(client, request, true)) {
+                cparse_free(buf);
                 return false;
             }
 
@@ -364,8 +421,8 @@ static bool cparse_client_set_request_url(cParseClient *client, cParseRequest *r
             }
 
         } else {
-            if (!cparse_request_build_body(client->cURL, request, false)) {
-                free(buf);
+            if (!cparse_request_build_body(client, request, false)) {
+                cparse_free(buf);
                 return false;
             }
 
@@ -377,69 +434,162 @@ static bool cparse_client_set_request_url(cParseClient *client, cParseRequest *r
     cparse_log_debug("URL: %s", buf);
 
     if (curl_easy_setopt(client->cURL, CURLOPT_URL, buf) != CURLE_OK) {
-        free(buf);
+        cparse_free(buf);
         return false;
     }
 
-    free(buf);
+    cparse_free(buf);
 
     return true;
 }
 
-static struct curl_slist *cparse_request_build_headers(cParseRequest *request)
+/* sets the correlation id for a request from the hooks or generates one */
+static void cparse_client_correlation_id(cParseRequest *request)
 {
-    struct curl_slist *headers = NULL;
+    const char *value = NULL;
 
-    if (request->headers != NULL) {
-        cParseRequestHeader *header = NULL;
+    if (cparse_trace_hooks.correlationId) {
+        value = cparse_trace_hooks.correlationId(request->id, cparse_trace_hooks.param);
+    }
 
-        for (header = request->headers; header != NULL; header = header->next) {
-            if (!cparse_curl_slist_append(&headers, "%s: %s", header->key, header->value)) {
-                cparse_log_error("Could not build HTTP headers for request, likely out of memory.");
-                return NULL;
-            }
+    if (value != NULL) {
+        snprintf(request->correlationId, CPARSE_CORRELATION_ID_SIZE, "%s", value);
+    } else {
+        snprintf(request->correlationId, CPARSE_CORRELATION_ID_SIZE, "cparse-%ld-%lu", (long)getpid(), request->id);
+    }
+}
+
+/* builds the headers specific to a request, which are sent before the client defaults */
+static bool cparse_request_build_headers(cParseClient *client, cParseRequest *request, struct curl_slist **headers)
+{
+    size_t i;
+
+    for (i = 0; i < cparse_dlist_size(&request->headers); i++) {
+        if (!cparse_curl_slist_append(headers, "%s: %s", cparse_dlist_key(&request->headers, i),
+                                      cparse_dlist_value(&request->headers, i))) {
+            return false;
         }
     }
 
-    if (headers == NULL) {
-        headers = cparse_this_client->headers;
-    } else {
-        struct curl_slist *header = NULL;
+    if (!cparse_str_empty(client->sessionToken)) {
+        if (!cparse_curl_slist_append(headers, "%s: %s", CPARSE_HEADER_SESSION_TOKEN, client->sessionToken)) {
+            return false;
+        }
+    }
 
-        for (header = headers; header != NULL; header = header->next) {
-            if (header->next == NULL) {
-                header->next = cparse_this_client->headers;
-                break;
-            }
+    if (!cparse_str_empty(cparse_correlation_header)) {
+        if (!cparse_curl_slist_append(headers, "%s: %s", cparse_correlation_header, request->correlationId)) {
+            return false;
         }
     }
 
-    return headers;
+    return true;
 }
 
-cParseResponse *cparse_client_execute(cParseRequest *request)
+/* logs a message with the details of a request */
+static void cparse_client_log_request_at(const char *func, CURL *curl, cParseRequest *request, cParseLogLevel level,
+                                         const char *const format, ...) __attribute__((format(printf, 5, 6)));
+
+/* logs a request from the calling function */
+#define cparse_client_log_request(curl, request, level, ...) \
+    cparse_client_log_request_at(__func__, curl, request, level, __VA_ARGS__)
+
+static void cparse_client_log_request_at(const char *func, CURL *curl, cParseRequest *request, cParseLogLevel level,
+                                         const char *const format, ...)
 {
-    cParseClient *client = NULL;
-    CURL *curl = NULL;
-    CURLcode res = 0;
-    cParseResponse *response = NULL;
-    struct curl_slist *headers = NULL;
+    cParseLogRecord record = {0};
+    char buf[CPARSE_BUF_SIZE + 1] = {0};
+    va_list args;
 
-    if (request == NULL) {
-        cparse_log_errno(EINVAL);
-        return NULL;
+    if (!cparse_log_enabled(level)) {
+        return;
     }
 
-    client = cparse_get_client();
+    record.level = level;
+    record.function = func;
+    record.requestId = request->id;
+    record.method = cParseHttpRequestMethodNames[request->method];
+    record.path = request->path;
+    record.status = request->response.code;
+    record.bytesSent = request->bodySize;
+    record.bytesReceived = request->response.size;
 
-    if (client == NULL) {
-        return NULL;
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &record.latency);
+
+    va_start(args, format);
+    vsnprintf(buf, CPARSE_BUF_SIZE, format, args);
+    va_end(args);
+
+    cparse_log_write_request(&record, "%s", buf);
+}
+
+/* records the timings and sizes of a request */
+static void cparse_client_record_metrics(CURL *curl, cParseRequest *request, bool error)
+{
+    cParseMetricsSample sample;
+    double dns = 0, connect = 0, tls = 0;
+
+    sample.endpoint = cparse_metrics_endpoint(request->path);
+    sample.error = error || request->response.code >= 400;
+    sample.bytesSent = request->bodySize;
+    sample.bytesReceived = request->response.size;
+
+    /* curl times are from the start of the request, make them durations of each phase */
+    curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME, &dns);
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME, &connect);
+    curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME, &tls);
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME, &sample.timings[cParseTimingFirstByte]);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &sample.timings[cParseTimingTotal]);
+
+    sample.timings[cParseTimingDns] = dns;
+    sample.timings[cParseTimingConnect] = connect > dns ? connect - dns : 0;
+    sample.timings[cParseTimingTls] = tls > connect ? tls - connect : 0;
+
+    cparse_metrics_record(&sample);
+}
+
+/* tests if a network failure may not happen again, local errors like a bad url will */
+static bool cparse_client_is_transient(CURLcode res)
+{
+    switch (res) {
+        case CURLE_COULDNT_RESOLVE_HOST:
+        case CURLE_COULDNT_CONNECT:
+        case CURLE_OPERATION_TIMEDOUT:
+        case CURLE_SEND_ERROR:
+        case CURLE_RECV_ERROR:
+        case CURLE_GOT_NOTHING:
+            return true;
+        default:
+            return false;
     }
+}
 
-    /* until i get around to simplifing this function */
-    curl = client->cURL;
+/* tests if a failed attempt can be sent again */
+static bool cparse_client_should_retry(cParseRequest *request, CURLcode res)
+{
+    if (request->attempt >= cparse_request_retries) {
+        return false;
+    }
 
-    pthread_mutex_lock(&client->lock);
+    /* a create that reached the server may have succeeded, so only retry if it never connected */
+    if (request->method == cParseHttpRequestMethodPost) {
+        return res == CURLE_COULDNT_RESOLVE_HOST || res == CURLE_COULDNT_CONNECT;
+    }
+
+    if (res != CURLE_OK) {
+        return cparse_client_is_transient(res);
+    }
+
+    return request->response.code == 429 || request->response.code >= 500;
+}
+
+/* sends one attempt of a request, the client must be locked */
+static CURLcode cparse_client_perform(cParseClient *client, cParseRequest *request)
+{
+    CURL *curl = client->cURL;
+    CURLcode res = CURLE_OK;
+    struct curl_slist *headers = NULL, *last = NULL;
+    long code = 0;
 
     /* reset from last request */
     curl_easy_reset(curl);
@@ -462,44 +612,134 @@ cParseResponse *cparse_client_execute(cParseRequest *request)
 
     curl_easy_setopt(curl, CURLOPT_TIMEOUT, client->timeout);
 
-    cparse_client_set_request_url(client, request);
+    if (!cparse_client_set_request_url(client, request)) {
+        return CURLE_URL_MALFORMAT;
+    }
 
     cparse_log_trace("Method: %s", cParseHttpRequestMethodNames[request->method]);
 
-    if (request->body) {
+    if (request->bodySize > 0) {
         cparse_log_trace("Body: %s", request->body);
     }
 
-    headers = cparse_request_build_headers(request);
+    if (!cparse_request_build_headers(client, request, &headers)) {
+        cparse_log_error("Could not build HTTP headers for request, likely out of memory.");
+        curl_slist_free_all(headers);
+        return CURLE_OUT_OF_MEMORY;
+    }
 
-    if (!cparse_str_empty(client->sessionToken)) {
-        if (!cparse_curl_slist_append(&headers, "%s: %s", CPARSE_HEADER_SESSION_TOKEN, client->sessionToken)) {
-            pthread_mutex_unlock(&client->lock);
-            return NULL;
-        }
+    /* link the client defaults after the request headers, and unlink them after so they are not freed */
+    if (headers == NULL) {
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, client->headers);
+    } else {
+        for (last = headers; last->next != NULL; last = last->next)
+            ;
+        last->next = client->headers;
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
     }
 
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    cparse_response_reset(&request->response);
 
-    response = cparse_response_new();
+    request->receiving = false;
 
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, cparse_client_get_response);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, request);
+
+    cparse_client_trace(cparse_trace_hooks.onStart, request, NULL);
 
     res = curl_easy_perform(curl);
 
+    if (last != NULL) {
+        last->next = NULL;
+        curl_slist_free_all(headers);
+    }
+
+    if (res == CURLE_OK) {
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
+
+        request->response.code = (int)code;
+
+        cparse_client_log_request(curl, request, cParseLogDebug, "cparse request attempt %d answered", request->attempt + 1);
+    }
+
+    return res;
+}
+
+cParseResponse *cparse_client_execute(cParseRequest *request)
+{
+    cParseClient *client = NULL;
+    CURLcode res = CURLE_OK;
+
+    if (request == NULL) {
+        cparse_log_errno(EINVAL);
+        return NULL;
+    }
+
+    client = cparse_get_client();
+
+    if (client == NULL) {
+        return NULL;
+    }
+
+    request->id = __atomic_add_fetch(&cparse_client_request_count, 1, __ATOMIC_RELAXED);
+    request->enqueued = cparse_client_now();
+    request->attempt = 0;
+    request->correlationId[0] = 0;
+    request->response.code = 0;
+
+    if (!cparse_str_empty(cparse_correlation_header) || cparse_trace_hooks.correlationId) {
+        cparse_client_correlation_id(request);
+    }
+
+    cparse_client_trace(cparse_trace_hooks.onEnqueue, request, NULL);
+
+    for (;;) {
+        pthread_mutex_lock(&client->lock);
+
+        res = cparse_client_perform(client, request);
+
+        if (!cparse_client_should_retry(request, res)) {
+            break;
+        }
+
+        cparse_client_log_request(client->cURL, request, cParseLogWarn, "retrying cparse request (%s)",
+                                  res != CURLE_OK ? curl_easy_strerror(res) : "server error");
+        cparse_client_record_metrics(client->cURL, request, true);
+
+        pthread_mutex_unlock(&client->lock);
+
+        cparse_client_trace(cparse_trace_hooks.onRetry, request, res != CURLE_OK ? curl_easy_strerror(res) : NULL);
+
+        /* back off 100ms, doubling each attempt */
+        {
+            struct timespec delay;
+            long ms = 100L << (request->attempt < 6 ? request->attempt : 6);
+
+            delay.tv_sec = ms / 1000;
+            delay.tv_nsec = (ms % 1000) * 1000000L;
+            nanosleep(&delay, NULL);
+        }
+
+        request->attempt++;
+    }
+
     if (res != CURLE_OK) {
-        cparse_log_error("problem with cparse request (%s)", curl_easy_strerror(res));
-        cparse_response_free(response);
+        cparse_client_log_request(client->cURL, request, cParseLogError, "problem with cparse request (%s)", curl_easy_strerror(res));
+        cparse_client_record_metrics(client->cURL, request, true);
         pthread_mutex_unlock(&client->lock);
+        cparse_client_trace(cparse_trace_hooks.onComplete, request, curl_easy_strerror(res));
         return NULL;
     }
 
-    cparse_log_trace("Response: %s", response->text);
+    cparse_log_trace("Response: %s", request->response.text);
 
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, (long *)&response->code);
+    cparse_client_log_request(client->cURL, request, cParseLogDebug, "request complete");
+
+    cparse_client_record_metrics(client->cURL, request, false);
 
     pthread_mutex_unlock(&client->lock);
 
-    return response;
+    cparse_client_trace(cparse_trace_hooks.onComplete, request, NULL);
+
+    return &request->response;
 }
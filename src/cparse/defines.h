@@ -23,6 +23,8 @@ typedef unsigned char bool;
 #include <stdbool.h>
 #endif
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 #define BEGIN_DECL extern "C" {
 #else
@@ -62,6 +64,9 @@ typedef struct cparse_query_builder cParseQueryBuilder;
 /*! An object callback function */
 typedef void (*cParseObjectCallback)(cParseObject *obj, cParseError *error, void *param);
 
+/*! A callback for a set of objects */
+typedef void (*cParseObjectListCallback)(cParseObject **objects, size_t count, cParseError *error, void *param);
+
 /*! a json structure */
 typedef struct json_object cParseJson;
 
@@ -10,6 +10,66 @@
 
 #include <cparse/defines.h>
 
+/*! the error codes from the parse server, and HTTP status codes for failed requests without one */
+typedef enum {
+    cParseErrorInternalServer = 1,
+    cParseErrorConnectionFailed = 100,
+    cParseErrorObjectNotFound = 101,
+    cParseErrorInvalidQuery = 102,
+    cParseErrorInvalidClassName = 103,
+    cParseErrorMissingObjectId = 104,
+    cParseErrorInvalidKeyName = 105,
+    cParseErrorInvalidPointer = 106,
+    cParseErrorInvalidJson = 107,
+    cParseErrorCommandUnavailable = 108,
+    cParseErrorNotInitialized = 109,
+    cParseErrorIncorrectType = 111,
+    cParseErrorInvalidChannelName = 112,
+    cParseErrorPushMisconfigured = 115,
+    cParseErrorObjectTooLarge = 116,
+    cParseErrorOperationForbidden = 119,
+    cParseErrorCacheMiss = 120,
+    cParseErrorInvalidNestedKey = 121,
+    cParseErrorInvalidFileName = 122,
+    cParseErrorInvalidAcl = 123,
+    cParseErrorTimeout = 124,
+    cParseErrorInvalidEmailAddress = 125,
+    cParseErrorDuplicateValue = 137,
+    cParseErrorInvalidRoleName = 139,
+    cParseErrorExceededQuota = 140,
+    cParseErrorScriptFailed = 141,
+    cParseErrorValidationFailed = 142,
+    cParseErrorFileDeleteFailed = 153,
+    cParseErrorRequestLimitExceeded = 155,
+    cParseErrorInvalidEventName = 160,
+    cParseErrorUsernameMissing = 200,
+    cParseErrorPasswordMissing = 201,
+    cParseErrorUsernameTaken = 202,
+    cParseErrorEmailTaken = 203,
+    cParseErrorEmailMissing = 204,
+    cParseErrorEmailNotFound = 205,
+    cParseErrorSessionMissing = 206,
+    cParseErrorMustCreateUserThroughSignup = 207,
+    cParseErrorAccountAlreadyLinked = 208,
+    cParseErrorInvalidSessionToken = 209,
+    cParseErrorLinkedIdMissing = 250,
+    cParseErrorInvalidLinkedSession = 251,
+    cParseErrorUnsupportedService = 252,
+    cParseErrorHttpBadRequest = 400,
+    cParseErrorHttpUnauthorized = 401,
+    cParseErrorHttpForbidden = 403,
+    cParseErrorHttpNotFound = 404,
+    cParseErrorHttpMethodNotAllowed = 405,
+    cParseErrorHttpRequestTimeout = 408,
+    cParseErrorHttpConflict = 409,
+    cParseErrorHttpPayloadTooLarge = 413,
+    cParseErrorHttpTooManyRequests = 429,
+    cParseErrorHttpInternalServerError = 500,
+    cParseErrorHttpBadGateway = 502,
+    cParseErrorHttpServiceUnavailable = 503,
+    cParseErrorHttpGatewayTimeout = 504
+} cParseErrorCode;
+
 BEGIN_DECL
 
 /*!
@@ -26,15 +86,30 @@ cParseError *cparse_error_new();
 cParseError *cparse_error_with_message(const char *message);
 
 /*!
- * allocates an error with a code and message
+ * gets an error for a code. Known codes return a shared error with a constant message, which is not allocated.
+ * @param code the error code, ex. a cParseErrorCode
+ * @return the error or NULL if out of memory
+ */
+cParseError *cparse_error_with_code(int code);
+
+/*!
+ * gets an error with a code and message. If the code is known and the message is NULL or the same as
+ * its constant message, a shared error is returned instead of allocating one.
  * @param code the error code
  * @param message the error message
- * @return the allocated error
+ * @return the error
  */
 cParseError *cparse_error_with_code_and_message(int code, const char *message);
 
 /*!
- * deallocates an error
+ * gets the constant message for an error code
+ * @param code the error code
+ * @return the message or NULL if the code is unknown
+ */
+const char *cparse_error_code_message(int code);
+
+/*!
+ * deallocates an error. Shared errors are not deallocated, so it is always safe to call.
  * @param error the error instance to deallocate
  */
 void cparse_error_free(cParseError *error);
@@ -47,7 +122,7 @@ void cparse_error_free(cParseError *error);
 const char *cparse_error_message(cParseError *error);
 
 /*!
- * sets the message for an error
+ * sets the message for an error. Shared errors can't be changed.
  * @param error the error instance
  * @param message the message to set
  */
@@ -61,7 +136,7 @@ void cparse_error_set_message(cParseError *error, const char *message);
 int cparse_error_code(cParseError *error);
 
 /*!
- * sets the code for an error
+ * sets the code for an error. Shared errors can't be changed.
  * @param error the error instance
  * @param code the code to set
  */
@@ -0,0 +1,92 @@
+/*!
+ * @file
+ * @header cParse Memory
+ * Functions for allocating and accounting the memory used by the library
+ */
+#ifndef CPARSE_MEMORY_H
+
+/*! @parseOnly */
+#define CPARSE_MEMORY_H
+
+#include <cparse/defines.h>
+
+/*! functions the library allocates memory with. Allocations must be aligned as malloc would. */
+typedef struct {
+    /*! allocates memory, ex. malloc */
+    void *(*allocate)(size_t size, void *param);
+    /*! resizes memory, ex. realloc */
+    void *(*reallocate)(void *ptr, size_t size, void *param);
+    /*! frees memory, ex. free */
+    void (*release)(void *ptr, void *param);
+    /*! a user defined parameter for the functions */
+    void *param;
+} cParseAllocator;
+
+/*! the memory used by the library */
+typedef struct {
+    /*! the bytes currently allocated */
+    size_t liveBytes;
+    /*! the most bytes allocated at once */
+    size_t peakBytes;
+    /*! the number of allocations not yet freed */
+    unsigned long liveAllocations;
+    /*! the total number of allocations */
+    unsigned long allocations;
+    /*! the number of allocations that failed or were over the limit */
+    unsigned long failures;
+} cParseMemoryStats;
+
+BEGIN_DECL
+
+/*! sets the functions the library allocates memory with. This includes memory allocated by curl, when the library
+ * initializes it. The json library does not support custom allocators, so json values are not included.
+ * This must be called before any other cparse function.
+ * @param allocator the functions to copy, or NULL to use malloc, realloc and free
+ * @return false if memory has already been allocated with the current functions
+ */
+bool cparse_set_allocator(const cParseAllocator *allocator);
+
+/*! sets the most bytes the library can allocate at once. Allocations over the limit fail as out of memory.
+ * @param bytes the limit, or zero for no limit
+ */
+void cparse_set_memory_limit(size_t bytes);
+
+/*! gets the memory used by the library
+ * @param stats the stats to fill
+ */
+void cparse_memory_stats(cParseMemoryStats *stats);
+
+/*! allocates memory with the library allocator
+ * @param size the number of bytes
+ * @return the memory or NULL if out of memory
+ */
+void *cparse_malloc(size_t size);
+
+/*! allocates zeroed memory with the library allocator
+ * @param count the number of elements
+ * @param size the size of an element
+ * @return the memory or NULL if out of memory
+ */
+void *cparse_calloc(size_t count, size_t size);
+
+/*! resizes memory allocated by the library
+ * @param ptr the memory, or NULL to allocate
+ * @param size the new size
+ * @return the memory or NULL if out of memory, in which case ptr is unchanged
+ */
+void *cparse_realloc(void *ptr, size_t size);
+
+/*! copies a string with the library allocator
+ * @param str the string to copy
+ * @return the copy or NULL if out of memory
+ */
+char *cparse_strdup(const char *str);
+
+/*! frees memory allocated by the library, ex. strings returned by cparse_build_string or cparse_metrics_to_prometheus
+ * @param ptr the memory to free, can be NULL
+ */
+void cparse_free(void *ptr);
+
+END_DECL
+
+#endif
@@ -0,0 +1,116 @@
+/*!
+ * @file
+ * @header cParse Metrics
+ * Functions for measuring requests
+ */
+#ifndef CPARSE_METRICS_H
+
+/*! @parseOnly */
+#define CPARSE_METRICS_H
+
+#include <cparse/defines.h>
+
+/*! the number of bounded histogram buckets */
+#define CPARSE_METRICS_BUCKETS 12
+
+/*! the kinds of endpoint requests are grouped by */
+typedef enum {
+    /*! class objects and queries */
+    cParseEndpointObjects,
+    /*! users, except for logging in */
+    cParseEndpointUsers,
+    /*! logging in */
+    cParseEndpointLogin,
+    /*! cloud functions */
+    cParseEndpointFunctions,
+    /*! batch requests */
+    cParseEndpointBatch,
+    /*! anything else */
+    cParseEndpointOther,
+    /*! the number of endpoints */
+    cParseEndpointCount
+} cParseEndpoint;
+
+/*! the phases of a request that are timed */
+typedef enum {
+    /*! resolving the host name */
+    cParseTimingDns,
+    /*! connecting to the host, after resolving */
+    cParseTimingConnect,
+    /*! the TLS handshake, after connecting */
+    cParseTimingTls,
+    /*! from the start of the request to the first response byte */
+    cParseTimingFirstByte,
+    /*! the whole request */
+    cParseTimingTotal,
+    /*! the number of timings */
+    cParseTimingCount
+} cParseTiming;
+
+/*! a histogram of times in seconds */
+typedef struct {
+    /*! the number of observations */
+    unsigned long count;
+    /*! the sum of all observations */
+    double sum;
+    /*! the number of observations in each bucket, see cparse_metrics_bucket. The last bucket has no upper bound. */
+    unsigned long buckets[CPARSE_METRICS_BUCKETS + 1];
+} cParseHistogram;
+
+/*! the metrics for an endpoint */
+typedef struct {
+    /*! the number of requests */
+    unsigned long requests;
+    /*! the number of requests that failed or returned an HTTP error */
+    unsigned long errors;
+    /*! the number of bytes sent */
+    unsigned long long bytesSent;
+    /*! the number of bytes received */
+    unsigned long long bytesReceived;
+    /*! the time taken by each phase of a request */
+    cParseHistogram timings[cParseTimingCount];
+} cParseEndpointMetrics;
+
+/*! the metrics for all requests */
+typedef struct {
+    /*! the metrics for each endpoint */
+    cParseEndpointMetrics endpoints[cParseEndpointCount];
+} cParseMetrics;
+
+BEGIN_DECL
+
+/*! copies the current metrics
+ * @param metrics the metrics to fill in
+ */
+void cparse_metrics_snapshot(cParseMetrics *metrics);
+
+/*! sets all metrics back to zero
+ */
+void cparse_metrics_reset();
+
+/*! gets the upper bound of a histogram bucket
+ * @param index the bucket index
+ * @return the upper bound in seconds, or zero if the bucket has no upper bound
+ */
+double cparse_metrics_bucket(size_t index);
+
+/*! gets the name of an endpoint
+ * @param endpoint the endpoint
+ * @return the name, ex. 'objects'
+ */
+const char *cparse_metrics_endpoint_name(cParseEndpoint endpoint);
+
+/*! gets the name of a timing
+ * @param timing the timing
+ * @return the name, ex. 'dns'
+ */
+const char *cparse_metrics_timing_name(cParseTiming timing);
+
+/*! formats the current metrics in the Prometheus text exposition format
+ * @return an allocated string that should be freed with cparse_free, or NULL if out of memory
+ */
+char *cparse_metrics_to_prometheus();
+
+END_DECL
+
+#endif
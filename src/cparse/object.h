@@ -159,6 +159,26 @@ bool cparse_object_fetch(cParseObject *obj, cParseError **error);
  */
 bool cparse_object_fetch_in_background(cParseObject *obj, cParseObjectCallback callback, void *param);
 
+/*! fetches the objects referenced by pointer attributes in a set of objects.
+ * The distinct ids are fetched with one query per class, and each pointer attribute is replaced with the fetched object.
+ * Objects pointing to the same id share one fetched value, so a change to it through one object is seen by the others.
+ * @param objects the object instances
+ * @param count the number of objects
+ * @param error a pointer to an error that gets allocated if not successful.
+ * @return true if successful
+ */
+bool cparse_object_fetch_pointers(cParseObject **objects, size_t count, cParseError **error);
+
+/*! fetches the objects referenced by pointer attributes in the background
+ * @param objects the object instances, which must remain valid until the callback
+ * @param count the number of objects
+ * @param callback the callback issued after the fetch
+ * @param param a user defined parameter for the callback
+ * @return true if the background thread was started
+ */
+bool cparse_object_fetch_pointers_in_background(cParseObject **objects, size_t count, cParseObjectListCallback callback,
+                                                void *param);
+
 /* setters */
 
 /*! tests if the object exists (was saved)
@@ -9,6 +9,7 @@
 #define CPARSE_PARSE_H
 
 #include <cparse/defines.h>
+#include <time.h>
 
 /*! levels of logging */
 typedef enum {
@@ -26,6 +27,82 @@ typedef enum {
     cParseLogTrace = 5
 } cParseLogLevel;
 
+/*! a log message passed to a log sink */
+typedef struct {
+    /*! the level of the message */
+    cParseLogLevel level;
+    /*! when the message was logged */
+    time_t timestamp;
+    /*! the library function that logged the message */
+    const char *function;
+    /*! the message text */
+    const char *message;
+    /*! the id of the request the message is about, or zero */
+    unsigned long requestId;
+    /*! the HTTP method of the request, or NULL if the message is not about a request */
+    const char *method;
+    /*! the request path */
+    const char *path;
+    /*! the HTTP status of the response */
+    int status;
+    /*! the time taken by the request in seconds */
+    double latency;
+    /*! the number of bytes sent */
+    size_t bytesSent;
+    /*! the number of bytes received */
+    size_t bytesReceived;
+} cParseLogRecord;
+
+/*! a function that receives log messages. The record is only valid for the duration of the call.
+ * @param record the log message
+ * @param param the user defined parameter passed to cparse_set_log_sink
+ */
+typedef void (*cParseLogSink)(const cParseLogRecord *record, void *param);
+
+/*! a point in the life of a request passed to a trace hook */
+typedef struct {
+    /*! the id of the request */
+    unsigned long requestId;
+    /*! the value sent in the correlation header, or NULL */
+    const char *correlationId;
+    /*! the HTTP method */
+    const char *method;
+    /*! the request path */
+    const char *path;
+    /*! the attempt number, starting at zero */
+    int attempt;
+    /*! the time in seconds since the request was enqueued */
+    double elapsed;
+    /*! the HTTP status, when complete */
+    int status;
+    /*! a description of the failure, or NULL */
+    const char *error;
+} cParseTraceEvent;
+
+/*! a function called at a point in the life of a request. Called on the requesting thread.
+ * @param event the trace event, only valid for the duration of the call
+ * @param param the user defined parameter in the hooks
+ */
+typedef void (*cParseTraceCallback)(const cParseTraceEvent *event, void *param);
+
+/*! callbacks for tracing requests. Any callback can be NULL. */
+typedef struct {
+    /*! the request is waiting for the client */
+    cParseTraceCallback onEnqueue;
+    /*! the request is being sent */
+    cParseTraceCallback onStart;
+    /*! the first byte of the response was received */
+    cParseTraceCallback onFirstByte;
+    /*! the request finished, successfully or not */
+    cParseTraceCallback onComplete;
+    /*! the request failed and will be sent again */
+    cParseTraceCallback onRetry;
+    /*! returns the value for the correlation header, ex. the current trace id. NULL or returning NULL generates one. */
+    const char *(*correlationId)(unsigned long requestId, void *param);
+    /*! a user defined parameter for the callbacks */
+    void *param;
+} cParseTraceHooks;
+
 BEGIN_DECL
 
 /*! sets the parse api application id
@@ -38,11 +115,52 @@ void cparse_set_application_id(const char *appId);
  */
 void cparse_set_api_key(const char *apiKey);
 
+/*! sets the url of the parse server that requests are sent to. The default is https://api.parse.com.
+ * @param url the base url without a trailing slash or the api version, ex. http://localhost:1337, or NULL for the default
+ */
+void cparse_set_server_url(const char *url);
+
 /*! sets the logging level
  * @param level the logging level to set
  */
 void cparse_set_log_level(cParseLogLevel level);
 
+/*! enables or disables asynchronous logging. When enabled, messages are formatted into a buffer on the
+ * calling thread and written by a background thread, so logging never blocks. Messages are dropped when
+ * a thread's buffer is full (see cparse_log_dropped_count). Disabling writes any queued messages.
+ * @param value the value to set
+ */
+void cparse_enable_async_logging(bool value);
+
+/*! gets the number of log messages dropped because a buffer was full
+ * @return the number of dropped messages
+ */
+unsigned long cparse_log_dropped_count();
+
+/*! sets where log messages are written. The default writes them to stdout.
+ * When async logging is enabled the sink is called from the logging thread.
+ * This should be set before logging starts.
+ * @param sink the log sink, or NULL for the default
+ * @param param a user defined parameter for the sink
+ */
+void cparse_set_log_sink(cParseLogSink sink, void *param);
+
+/*! sets the callbacks for tracing requests. This should be set before any requests are made.
+ * @param hooks the hooks to copy, or NULL to disable tracing
+ */
+void cparse_set_trace_hooks(const cParseTraceHooks *hooks);
+
+/*! sets a header that each request sends with a correlation id, ex. 'X-Request-Id'
+ * @param name the header name, or NULL to not send one
+ */
+void cparse_set_correlation_header(const char *name);
+
+/*! sets how many times a request is sent again after a network failure or a server error.
+ * Requests that create objects are only sent again if they could not connect. The default is zero.
+ * @param count the number of retries
+ */
+void cparse_set_request_retries(int count);
+
 
 /*! enables revocable sessions
  * @param value the value to set
@@ -49,6 +49,15 @@ size_t cparse_query_size(cParseQuery *query);
  */
 cParseObject *cparse_query_result(cParseQuery *query, size_t index);
 
+/*! sets if the results of a query are lazy.  A lazy result is a view over the response that is only merged into a
+ * full object when its id, dates or other metadata are accessed or when it is modified.  Until then the attribute
+ * getters read directly from the response, without the objectId, createdAt and updatedAt keys, which are never
+ * attributes.  Modifying a result changes a copy, never the response.
+ * @param query the query instance
+ * @param value true for lazy results
+ */
+void cparse_query_set_lazy_results(cParseQuery *query, bool value);
+
 /*! sets the where clause of a query
  * @param query the query instance
  * @param where a json object describing the where clause (see https://parse.com/docs/rest#queries)
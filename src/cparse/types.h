@@ -31,6 +31,20 @@ bool cparse_json_is_pointer(cParseJson *json);
  */
 bool cparse_json_is_bytes(cParseJson *json);
 
+/*! creates a byte array json representation, encoding the data as base64
+ * @param data the bytes
+ * @param size the number of bytes
+ * @return a json representation of the bytes or NULL if out of memory
+ */
+cParseJson *cparse_bytes_from_data(const void *data, size_t size);
+
+/*! decodes the data of a byte array json representation
+ * @param json the byte array
+ * @param size set to the number of bytes
+ * @return the bytes, to be freed with cparse_free, or NULL if the json is not a valid byte array
+ */
+void *cparse_bytes_to_data(cParseJson *json, size_t *size);
+
 /*! tests if a json object is a file
  * @param json the json to test
  * @return true if the json represents a file
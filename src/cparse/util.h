@@ -22,11 +22,17 @@ int cparse_str_empty(const char *str);
 
 /*! parses a date time string
  * @param str the string to parse
- * @return a timestamp
+ * @return a UTC timestamp or zero if the string is not a valid date
  */
 time_t cparse_date_time(const char *str);
 
-/*! replaces an allocated string
+/*! parses a date time string with millisecond precision
+ * @param str the string to parse
+ * @return the UTC milliseconds since the epoch or zero if the string is not a valid date
+ */
+long long cparse_date_time_ms(const char *str);
+
+/*! replaces a string allocated with cparse_malloc
  * @param a the string to replace
  * @param b the string to copy from
  */
@@ -47,7 +53,7 @@ int cparse_str_prefix(const char *a, const char *b);
 int cparse_str_cmp(const char *a, const char *b);
 
 /*! appends a string to another
- * Note: this function deals with allocated strings only
+ * Note: this function deals with strings allocated with cparse_malloc only
  * @param pstr	a pointer to the string to append to
  * @param size  the size of string to append to
  * @param append the string to append
@@ -55,7 +61,7 @@ int cparse_str_cmp(const char *a, const char *b);
  */
 bool cparse_str_append(char **pstr, const char *append, size_t size);
 
-/*! builds a dynamic string
+/*! builds a dynamic string, allocated with cparse_malloc
  * @param buf a pointer to a string to build
  * @return true if successful
  */
@@ -1,74 +1,155 @@
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
+#include <cparse/memory.h>
 #include "data_list.h"
 #include "log.h"
 
-/*! allocates a new key value list */
-cParseDataList *cparse_dlist_new()
+void cparse_dlist_init(cParseDataList *list)
 {
-    cParseDataList *list = malloc(sizeof(cParseDataList));
+    if (!list) {
+        return;
+    }
 
-    if (list == NULL) {
-        cparse_log_errno(ENOMEM);
-        return NULL;
+    list->entries = list->inlineEntries;
+    list->size = 0;
+    list->capacity = CPARSE_DLIST_INLINE_SIZE;
+    list->values = list->inlineValues;
+    list->valuesSize = 0;
+    list->valuesCapacity = CPARSE_DLIST_INLINE_BYTES;
+}
+
+void cparse_dlist_destroy(cParseDataList *list)
+{
+    if (!list) {
+        return;
     }
 
-    list->next = NULL;
-    list->key = NULL;
-    list->value = NULL;
-    return list;
+    if (list->entries != list->inlineEntries) {
+        cparse_free(list->entries);
+    }
+    if (list->values != list->inlineValues) {
+        cparse_free(list->values);
+    }
+
+    cparse_dlist_init(list);
 }
 
-/*! deallocates a key value list */
-void cparse_dlist_free(cParseDataList *list)
+void cparse_dlist_clear(cParseDataList *list)
 {
     if (!list) {
         return;
     }
 
-    if (list->key) {
-        free(list->key);
+    list->size = 0;
+    list->valuesSize = 0;
+}
+
+void cparse_dlist_wipe(cParseDataList *list)
+{
+    if (!list) {
+        return;
     }
-    if (list->value) {
-        free(list->value);
+
+    memset(list->values, 0, list->valuesSize);
+
+    cparse_dlist_clear(list);
+}
+
+/* grows a buffer, moving it off the inline storage if needed */
+static void *cparse_dlist_grow(void *buf, const void *inlineBuf, size_t used, size_t capacity)
+{
+    void *grown = NULL;
+
+    if (buf == inlineBuf) {
+        grown = cparse_malloc(capacity);
+
+        if (grown != NULL) {
+            memcpy(grown, buf, used);
+        }
+    } else {
+        grown = cparse_realloc(buf, capacity);
     }
-    free(list);
+
+    if (grown == NULL) {
+        cparse_log_errno(ENOMEM);
+    }
+
+    return grown;
 }
 
-void cparse_dlist_remove(cParseDataList **list, bool (*funk)(cParseDataList *))
+bool cparse_dlist_add(cParseDataList *list, const char *key, const char *value)
 {
-    cParseDataList *data = NULL, *prev_data = NULL, *next_data = NULL;
+    size_t len = 0;
 
-    if (list == NULL) {
+    if (!list || !value) {
         cparse_log_errno(EINVAL);
-        return;
+        return false;
     }
 
-    for (prev_data = NULL, data = *list, next_data = NULL; data != NULL; data = next_data) {
-        next_data = data->next;
-
-        /* body has no key */
-        if (funk(data)) {
-            if (prev_data) {
-                prev_data->next = data->next;
-            } else {
-                *list = data->next;
-            }
-            cparse_dlist_free(data);
+    len = strlen(value) + 1;
+
+    if (list->size == list->capacity) {
+        cParseDataListEntry *entries = cparse_dlist_grow(list->entries, list->inlineEntries, list->size * sizeof(cParseDataListEntry),
+                                                         list->capacity * 2 * sizeof(cParseDataListEntry));
+
+        if (entries == NULL) {
+            return false;
+        }
+
+        list->entries = entries;
+        list->capacity *= 2;
+    }
+
+    if (list->valuesSize + len > list->valuesCapacity) {
+        size_t capacity = list->valuesCapacity * 2;
+        char *values = NULL;
+
+        while (capacity < list->valuesSize + len) {
+            capacity *= 2;
+        }
+
+        values = cparse_dlist_grow(list->values, list->inlineValues, list->valuesSize, capacity);
+
+        if (values == NULL) {
+            return false;
         }
 
-        prev_data = data;
+        list->values = values;
+        list->valuesCapacity = capacity;
     }
 
-    return;
+    /* values are stored as offsets so the buffer can move */
+    memcpy(list->values + list->valuesSize, value, len);
+
+    list->entries[list->size].key = key;
+    list->entries[list->size].value = list->valuesSize;
+
+    list->valuesSize += len;
+    list->size++;
+
+    return true;
 }
 
-bool cparse_dlist_is_value(cParseDataList *data)
+size_t cparse_dlist_size(const cParseDataList *list)
 {
-    return data->key == NULL;
+    return list ? list->size : 0;
 }
 
-bool cparse_dlist_is_data(cParseDataList *data)
+const char *cparse_dlist_key(const cParseDataList *list, size_t index)
 {
-    return data->key != NULL;
+    if (!list || index >= list->size) {
+        return NULL;
+    }
+
+    return list->entries[index].key;
+}
+
+const char *cparse_dlist_value(const cParseDataList *list, size_t index)
+{
+    if (!list || index >= list->size) {
+        return NULL;
+    }
+
+    return list->values + list->entries[index].value;
 }
@@ -3,26 +3,58 @@
 
 #include <cparse/defines.h>
 
+/*! the number of entries a list holds before allocating */
+#define CPARSE_DLIST_INLINE_SIZE 8
+
+/*! the number of value bytes a list holds before allocating */
+#define CPARSE_DLIST_INLINE_BYTES 256
+
 typedef struct cparse_dlist cParseDataList;
 
-/*! a simple key value linked list */
+/*! a key value entry */
+typedef struct cparse_dlist_entry {
+    /* not copied, must outlive the list (usually a literal). NULL for a value without a key */
+    const char *key;
+    /* offset of the value in the list's value buffer */
+    size_t value;
+} cParseDataListEntry;
+
+/*! a simple key value vector. Storage is kept when cleared so a list can be reused. */
 struct cparse_dlist {
-    struct cparse_dlist *next;
-    char *key;
-    char *value;
+    cParseDataListEntry *entries;
+    size_t size;
+    size_t capacity;
+    char *values;
+    size_t valuesSize;
+    size_t valuesCapacity;
+    cParseDataListEntry inlineEntries[CPARSE_DLIST_INLINE_SIZE];
+    char inlineValues[CPARSE_DLIST_INLINE_BYTES];
 };
 
 BEGIN_DECL
 
-cParseDataList *cparse_dlist_new();
+/*! initializes an empty list using its inline storage */
+void cparse_dlist_init(cParseDataList *list);
+
+/*! releases any storage allocated by a list */
+void cparse_dlist_destroy(cParseDataList *list);
+
+/*! removes all entries, keeping the storage */
+void cparse_dlist_clear(cParseDataList *list);
+
+/*! removes all entries and zeroes their values, so nothing is left in the kept storage */
+void cparse_dlist_wipe(cParseDataList *list);
 
-void cparse_dlist_free(cParseDataList *list);
+/*! adds an entry. The key is referenced, the value is copied.
+ * \returns false if out of memory
+ */
+bool cparse_dlist_add(cParseDataList *list, const char *key, const char *value);
 
-void cparse_dlist_remove(cParseDataList **list, bool (*funk)(cParseDataList *));
+size_t cparse_dlist_size(const cParseDataList *list);
 
-bool cparse_dlist_is_data(cParseDataList *data);
+const char *cparse_dlist_key(const cParseDataList *list, size_t index);
 
-bool cparse_dlist_is_value(cParseDataList *data);
+const char *cparse_dlist_value(const cParseDataList *list, size_t index);
 
 END_DECL
 
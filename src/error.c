@@ -1,18 +1,105 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <cparse/error.h>
+#include <cparse/memory.h>
 #include <string.h>
 #include "log.h"
 #include <errno.h>
 
 struct cparse_error {
     int code;
-    char *message;
+    const char *message;
+    /* the message, if it was copied */
+    char *buffer;
+    /* errors from the table are shared and never freed */
+    bool shared;
 };
 
+/* the known parse and HTTP error codes, sorted by code */
+static cParseError cparse_errors[] = {
+    {cParseErrorInternalServer, "internal server error", NULL, true},
+    {cParseErrorConnectionFailed, "connection failed", NULL, true},
+    {cParseErrorObjectNotFound, "object not found", NULL, true},
+    {cParseErrorInvalidQuery, "invalid query", NULL, true},
+    {cParseErrorInvalidClassName, "invalid class name", NULL, true},
+    {cParseErrorMissingObjectId, "object has no id", NULL, true},
+    {cParseErrorInvalidKeyName, "invalid key name", NULL, true},
+    {cParseErrorInvalidPointer, "invalid pointer", NULL, true},
+    {cParseErrorInvalidJson, "invalid json", NULL, true},
+    {cParseErrorCommandUnavailable, "command unavailable", NULL, true},
+    {cParseErrorNotInitialized, "not initialized", NULL, true},
+    {cParseErrorIncorrectType, "incorrect type", NULL, true},
+    {cParseErrorInvalidChannelName, "invalid channel name", NULL, true},
+    {cParseErrorPushMisconfigured, "push misconfigured", NULL, true},
+    {cParseErrorObjectTooLarge, "object too large", NULL, true},
+    {cParseErrorOperationForbidden, "operation forbidden", NULL, true},
+    {cParseErrorCacheMiss, "cache miss", NULL, true},
+    {cParseErrorInvalidNestedKey, "invalid nested key", NULL, true},
+    {cParseErrorInvalidFileName, "invalid file name", NULL, true},
+    {cParseErrorInvalidAcl, "invalid acl", NULL, true},
+    {cParseErrorTimeout, "request timed out", NULL, true},
+    {cParseErrorInvalidEmailAddress, "invalid email address", NULL, true},
+    {cParseErrorDuplicateValue, "duplicate value", NULL, true},
+    {cParseErrorInvalidRoleName, "invalid role name", NULL, true},
+    {cParseErrorExceededQuota, "exceeded quota", NULL, true},
+    {cParseErrorScriptFailed, "cloud code script failed", NULL, true},
+    {cParseErrorValidationFailed, "cloud code validation failed", NULL, true},
+    {cParseErrorFileDeleteFailed, "file delete failed", NULL, true},
+    {cParseErrorRequestLimitExceeded, "request limit exceeded", NULL, true},
+    {cParseErrorInvalidEventName, "invalid event name", NULL, true},
+    {cParseErrorUsernameMissing, "username missing", NULL, true},
+    {cParseErrorPasswordMissing, "password missing", NULL, true},
+    {cParseErrorUsernameTaken, "username taken", NULL, true},
+    {cParseErrorEmailTaken, "email taken", NULL, true},
+    {cParseErrorEmailMissing, "email missing", NULL, true},
+    {cParseErrorEmailNotFound, "email not found", NULL, true},
+    {cParseErrorSessionMissing, "session missing", NULL, true},
+    {cParseErrorMustCreateUserThroughSignup, "must create user through sign up", NULL, true},
+    {cParseErrorAccountAlreadyLinked, "account already linked", NULL, true},
+    {cParseErrorInvalidSessionToken, "invalid session token", NULL, true},
+    {cParseErrorLinkedIdMissing, "linked id missing", NULL, true},
+    {cParseErrorInvalidLinkedSession, "invalid linked session", NULL, true},
+    {cParseErrorUnsupportedService, "unsupported service", NULL, true},
+    {cParseErrorHttpBadRequest, "bad request", NULL, true},
+    {cParseErrorHttpUnauthorized, "unauthorized", NULL, true},
+    {cParseErrorHttpForbidden, "forbidden", NULL, true},
+    {cParseErrorHttpNotFound, "not found", NULL, true},
+    {cParseErrorHttpMethodNotAllowed, "method not allowed", NULL, true},
+    {cParseErrorHttpRequestTimeout, "request timeout", NULL, true},
+    {cParseErrorHttpConflict, "conflict", NULL, true},
+    {cParseErrorHttpPayloadTooLarge, "payload too large", NULL, true},
+    {cParseErrorHttpTooManyRequests, "too many requests", NULL, true},
+    {cParseErrorHttpInternalServerError, "internal server error", NULL, true},
+    {cParseErrorHttpBadGateway, "bad gateway", NULL, true},
+    {cParseErrorHttpServiceUnavailable, "service unavailable", NULL, true},
+    {cParseErrorHttpGatewayTimeout, "gateway timeout", NULL, true},
+};
+
+/* finds the shared error for a code */
+static cParseError *cparse_error_lookup(int code)
+{
+    size_t low = 0, high = sizeof(cparse_errors) / sizeof(cparse_errors[0]);
+
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+
+        if (cparse_errors[mid].code == code) {
+            return &cparse_errors[mid];
+        }
+
+        if (cparse_errors[mid].code < code) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return NULL;
+}
+
 cParseError *cparse_error_new()
 {
-    cParseError *e = malloc(sizeof(cParseError));
+    cParseError *e = cparse_malloc(sizeof(cParseError));
 
     if (e == NULL) {
         cparse_log_errno(ENOMEM);
@@ -21,6 +108,8 @@ cParseError *cparse_error_new()
 
     e->code = 0;
     e->message = NULL;
+    e->buffer = NULL;
+    e->shared = false;
 
     return e;
 }
@@ -33,36 +122,68 @@ cParseError *cparse_error_with_message(const char *message)
         return NULL;
     }
 
-    e->message = strdup(message);
+    cparse_error_set_message(e, message);
+
+    return e;
+}
+
+cParseError *cparse_error_with_code(int code)
+{
+    cParseError *e = cparse_error_lookup(code);
+
+    if (e != NULL) {
+        return e;
+    }
+
+    e = cparse_error_new();
+
+    if (e != NULL) {
+        e->code = code;
+    }
 
     return e;
 }
 
 cParseError *cparse_error_with_code_and_message(int code, const char *message)
 {
-    cParseError *e = cparse_error_new();
+    cParseError *e = cparse_error_lookup(code);
+
+    /* only copy a message that says something different */
+    if (e != NULL && (message == NULL || !strcmp(e->message, message))) {
+        return e;
+    }
+
+    e = cparse_error_new();
 
     if (e == NULL) {
         return NULL;
     }
 
     e->code = code;
-    e->message = strdup(message);
+
+    cparse_error_set_message(e, message);
 
     return e;
 }
 
+const char *cparse_error_code_message(int code)
+{
+    cParseError *e = cparse_error_lookup(code);
+
+    return e ? e->message : NULL;
+}
+
 void cparse_error_free(cParseError *e)
 {
-    if (!e) {
+    if (!e || e->shared) {
         return;
     }
 
-    if (e->message) {
-        free(e->message);
+    if (e->buffer) {
+        cparse_free(e->buffer);
     }
 
-    free(e);
+    cparse_free(e);
 }
 
 const char *cparse_error_message(cParseError *error)
@@ -72,9 +193,21 @@ const char *cparse_error_message(cParseError *error)
 
 void cparse_error_set_message(cParseError *error, const char *message)
 {
-    if (error) {
-        error->message = strdup(message);
+    char *copy = NULL;
+
+    if (!error || error->shared) {
+        return;
     }
+
+    /* copy first in case the message is the current one */
+    copy = message ? cparse_strdup(message) : NULL;
+
+    if (error->buffer) {
+        cparse_free(error->buffer);
+    }
+
+    error->buffer = copy;
+    error->message = copy;
 }
 
 int cparse_error_code(cParseError *error)
@@ -84,7 +217,7 @@ int cparse_error_code(cParseError *error)
 
 void cparse_error_set_code(cParseError *error, int code)
 {
-    if (error) {
+    if (error && !error->shared) {
         error->code = code;
     }
 }
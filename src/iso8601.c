@@ -0,0 +1,142 @@
+#include "iso8601.h"
+
+#define CPARSE_ISO8601_DIGIT(c) ((unsigned)((c) - '0') < 10)
+
+/* parses a fixed number of digits, returns -1 if any are not digits */
+static int cparse_iso8601_number(const char *str, int count)
+{
+    int value = 0;
+
+    for (; count > 0; count--, str++) {
+        if (!CPARSE_ISO8601_DIGIT(*str)) {
+            return -1;
+        }
+        value = value * 10 + (*str - '0');
+    }
+
+    return value;
+}
+
+/* the number of days since 1970-01-01 for a proleptic gregorian date
+ * see http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+ */
+static long long cparse_iso8601_days(int year, int month, int day)
+{
+    int era = 0;
+    unsigned yoe = 0, doy = 0, doe = 0;
+
+    year -= month <= 2;
+    era = (year >= 0 ? year : year - 399) / 400;
+    yoe = (unsigned)(year - era * 400);
+    doy = (153 * (unsigned)(month > 2 ? month - 3 : month + 9) + 2) / 5 + (unsigned)day - 1;
+    doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return (long long)era * 146097 + (long long)doe - 719468;
+}
+
+/* the number of days in a month of the proleptic gregorian calendar */
+static int cparse_iso8601_month_days(int year, int month)
+{
+    static const int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+    if (month == 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) {
+        return 29;
+    }
+
+    return days[month - 1];
+}
+
+int cparse_iso8601_parse(const char *str, long long *millis)
+{
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0, ms = 0, offset = 0;
+
+    if (str == 0 || millis == 0) {
+        return 0;
+    }
+
+    /* YYYY-MM-DD */
+    year = cparse_iso8601_number(str, 4);
+    if (year < 0 || str[4] != '-') {
+        return 0;
+    }
+    month = cparse_iso8601_number(str + 5, 2);
+    if (month < 1 || month > 12 || str[7] != '-') {
+        return 0;
+    }
+    day = cparse_iso8601_number(str + 8, 2);
+    if (day < 1 || day > cparse_iso8601_month_days(year, month)) {
+        return 0;
+    }
+    str += 10;
+
+    /* THH:MM[:SS[.fff]] */
+    if (*str == 'T' || *str == 't' || *str == ' ') {
+        hour = cparse_iso8601_number(str + 1, 2);
+        if (hour < 0 || hour > 23 || str[3] != ':') {
+            return 0;
+        }
+        minute = cparse_iso8601_number(str + 4, 2);
+        if (minute < 0 || minute > 59) {
+            return 0;
+        }
+        str += 6;
+
+        if (*str == ':') {
+            second = cparse_iso8601_number(str + 1, 2);
+            /* allow for a leap second */
+            if (second < 0 || second > 60) {
+                return 0;
+            }
+            str += 3;
+
+            if (*str == '.' || *str == ',') {
+                int scale = 100;
+
+                if (!CPARSE_ISO8601_DIGIT(*++str)) {
+                    return 0;
+                }
+                /* keep millisecond precision, ignore the rest */
+                for (; CPARSE_ISO8601_DIGIT(*str); str++) {
+                    ms += (*str - '0') * scale;
+                    scale /= 10;
+                }
+            }
+        }
+    }
+
+    /* Z, +HH:MM, +HHMM or +HH */
+    if (*str == 'Z' || *str == 'z') {
+        str++;
+    } else if (*str == '+' || *str == '-') {
+        int sign = *str == '-' ? -1 : 1;
+        int tzh = cparse_iso8601_number(str + 1, 2);
+        int tzm = 0;
+
+        if (tzh < 0 || tzh > 23) {
+            return 0;
+        }
+        str += 3;
+
+        if (*str == ':') {
+            str++;
+        }
+
+        if (CPARSE_ISO8601_DIGIT(*str)) {
+            tzm = cparse_iso8601_number(str, 2);
+            if (tzm < 0 || tzm > 59) {
+                return 0;
+            }
+            str += 2;
+        }
+
+        offset = sign * (tzh * 3600 + tzm * 60);
+    }
+
+    if (*str != '\0') {
+        return 0;
+    }
+
+    *millis = ((cparse_iso8601_days(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - offset) * 1000) + ms;
+
+    return 1;
+}
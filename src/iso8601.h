@@ -0,0 +1,24 @@
+#ifndef CPARSE_ISO8601_H_
+#define CPARSE_ISO8601_H_
+
+/*
+ * This header is shared with the C++ library, so it only depends on the C standard library.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! parses an ISO-8601 date time string (ex. 2011-08-20T02:06:57.931Z) into UTC milliseconds since the epoch.
+ * Does not use the locale or the timezone database.
+ * \param str the string to parse
+ * \param millis set to the parsed time if successful
+ * \returns non-zero if the string was a valid date time
+ */
+int cparse_iso8601_parse(const char *str, long long *millis);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,152 +1,608 @@
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
+#if defined(HAVE_DLADDR) && defined(CPARSE_LOG_CALLERS) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 #include <cparse/parse.h>
 #include <cparse/error.h>
 #include <cparse/util.h>
+#include <cparse/memory.h>
 #include <stdio.h>
 #include <time.h>
+#if defined(HAVE_DLADDR) && defined(CPARSE_LOG_CALLERS)
 #include <execinfo.h>
 #include <dlfcn.h>
+#endif
+#include <pthread.h>
 #include "log.h"
 #include "protocol.h"
 
+/* the number of records a thread can queue, must be a power of two */
+#define CPARSE_LOG_RING_SIZE 128
+
+/* the longest message kept in a record */
+#define CPARSE_LOG_RECORD_SIZE 512
+
+/* the longest request path kept in a record */
+#define CPARSE_LOG_PATH_SIZE 256
+
+/* messages up to this size are formatted without allocating */
+#define CPARSE_LOG_BUF_SIZE 1024
+
+/* how long the writer sleeps when there is nothing to write, in milliseconds */
+#define CPARSE_LOG_WRITER_INTERVAL 10
+
 const char *cParseLogLevelNames[] = {"UNKNOWN", "ERROR", "WARN", "INFO", "DEBUG", "TRACE"};
 
 cParseLogLevel cparse_current_log_level;
 
-static void cparse_log_vargs(cParseLogLevel level, const char *const format, va_list args)
+/*! a formatted log message waiting to be written */
+typedef struct {
+    /* the function and method are literals, the message and path point into this struct */
+    cParseLogRecord record;
+    char text[CPARSE_LOG_RECORD_SIZE];
+    char path[CPARSE_LOG_PATH_SIZE];
+} cParseLogMessage;
+
+/*! a single producer, single consumer queue of records for a thread */
+typedef struct cparse_log_ring {
+    cParseLogMessage messages[CPARSE_LOG_RING_SIZE];
+    /* the next record to write, only changed by the owning thread */
+    size_t head;
+    /* the next record to read, only changed by the thread draining */
+    size_t tail;
+    unsigned long dropped;
+    /* the owning thread has exited */
+    int closed;
+    struct cparse_log_ring *next;
+} cParseLogRing;
+
+/* the number of records copied out of a ring at a time, so the sink runs without the lock */
+#define CPARSE_LOG_BATCH_SIZE 16
+
+/* guards draining, unlinking and freeing rings, and the writer state. never taken when logging a message,
+ * and never held while the sink runs */
+static pthread_mutex_t cparse_log_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_cond_t cparse_log_wake = PTHREAD_COND_INITIALIZER;
+
+/* signaled when a thread stops draining */
+static pthread_cond_t cparse_log_drained = PTHREAD_COND_INITIALIZER;
+
+/* serializes enabling and disabling async logging, held until the writer has been joined */
+static pthread_mutex_t cparse_log_control = PTHREAD_MUTEX_INITIALIZER;
+
+/* guards the sink and its parameter, which are read together */
+static pthread_mutex_t cparse_log_sink_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_once_t cparse_log_once = PTHREAD_ONCE_INIT;
+
+static pthread_key_t cparse_log_key;
+
+static pthread_t cparse_log_writer;
+
+static int cparse_log_async = 0;
+
+/* a thread is writing records, only one drains at a time */
+static int cparse_log_draining = 0;
+
+/* new rings are pushed without the lock, only the thread draining unlinks them */
+static cParseLogRing *cparse_log_rings = NULL;
+
+/* drops counted by rings that have been freed */
+static unsigned long cparse_log_dropped = 0;
+
+static void cparse_log_default_sink(const cParseLogRecord *record, void *param);
+
+static cParseLogSink cparse_log_sink = cparse_log_default_sink;
+
+static void *cparse_log_sink_param = NULL;
+
+/* writes a record to stdout */
+static void cparse_log_default_sink(const cParseLogRecord *record, void *param)
 {
     char buf[BUFSIZ + 1] = {0};
+    struct tm tm;
 
-    time_t t = 0;
+    strftime(buf, BUFSIZ, "%Y-%m-%d %H:%M:%S", localtime_r(&record->timestamp, &tm));
 
-    if (cparse_str_empty(format)) {
-        return;
+    if (record->method != NULL) {
+        fprintf(stdout, "%s %s: [%s] %s (%s %s %d %.3fs %zu/%zu bytes)\n", buf, cParseLogLevelNames[record->level], record->function,
+                record->message, record->method, record->path ? record->path : "", record->status, record->latency, record->bytesSent,
+                record->bytesReceived);
+    } else {
+        fprintf(stdout, "%s %s: [%s] %s\n", buf, cParseLogLevelNames[record->level], record->function, record->message);
     }
+}
 
-    t = time(0);
+void cparse_set_log_sink(cParseLogSink sink, void *param)
+{
+    pthread_mutex_lock(&cparse_log_sink_lock);
+    cparse_log_sink_param = param;
+    cparse_log_sink = sink ? sink : cparse_log_default_sink;
+    pthread_mutex_unlock(&cparse_log_sink_lock);
+}
 
-#ifdef HAVE_DLADDR
+/* gets the sink and its parameter as they were set together */
+static void cparse_log_get_sink(cParseLogSink *sink, void **param)
+{
+    pthread_mutex_lock(&cparse_log_sink_lock);
+    *sink = cparse_log_sink;
+    *param = cparse_log_sink_param;
+    pthread_mutex_unlock(&cparse_log_sink_lock);
+}
 
-    const char *last_func = "unk";
+/* waits for any other thread to finish draining. called with the lock held */
+static void cparse_log_begin_drain()
+{
+    while (cparse_log_draining) {
+        pthread_cond_wait(&cparse_log_drained, &cparse_log_lock);
+    }
 
-    void *callstack[4];
+    cparse_log_draining = 1;
+}
+
+/* called with the lock held */
+static void cparse_log_end_drain()
+{
+    cparse_log_draining = 0;
 
-    int frames = backtrace(callstack, 4);
+    pthread_cond_broadcast(&cparse_log_drained);
+}
 
-    Dl_info info;
+/* copies up to max queued records of a ring into a batch and frees their slots. called with the lock held */
+static size_t cparse_log_take(cParseLogRing *ring, cParseLogMessage *batch, size_t max)
+{
+    size_t tail = ring->tail;
+    size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    size_t count = 0;
+
+    for (; tail != head && count < max; tail++, count++) {
+        cParseLogMessage *message = &batch[count];
+
+        *message = ring->messages[tail & (CPARSE_LOG_RING_SIZE - 1)];
+
+        /* point into the copy instead of the ring */
+        message->record.message = message->text;
 
-    if (frames > 0) {
-        if (dladdr(callstack[2], &info) && info.dli_sname) {
-            last_func = info.dli_sname;
+        if (message->record.path != NULL) {
+            message->record.path = message->path;
         }
     }
-#endif
 
-    strftime(buf, BUFSIZ, "%Y-%m-%d %H:%M:%S", localtime(&t));
+    __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
 
-#ifdef HAVE_DLADDR
-    fprintf(stdout, "%s %s: [%s] ", buf, cParseLogLevelNames[level], last_func);
-#else
-    fprintf(stdout, "%s %s: ", buf, cParseLogLevelNames[level]);
-#endif
+    return count;
+}
 
-    vfprintf(stdout, format, args);
-    fputs("\n", stdout);
-    fflush(stdout);
+/* unlinks and frees a ring. called with the lock held by the thread draining */
+static void cparse_log_ring_free(cParseLogRing *ring)
+{
+    cParseLogRing *head = ring;
+    cParseLogRing **prev = NULL;
+
+    /* the head can change under us as rings are pushed, the rest of the list can't */
+    if (!__atomic_compare_exchange_n(&cparse_log_rings, &head, ring->next, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        for (prev = &head->next; *prev != NULL; prev = &(*prev)->next) {
+            if (*prev == ring) {
+                *prev = ring->next;
+                break;
+            }
+        }
+    }
+
+    cparse_log_dropped += ring->dropped;
+
+    cparse_free(ring);
 }
 
-void cparse_log_error(const char *const format, ...)
+/* writes all queued records and frees the rings of exited threads. called with the lock held by the thread
+ * draining, the lock is released while the sink runs. returns the number of records written */
+static size_t cparse_log_drain_all()
 {
-    va_list args;
+    cParseLogMessage batch[CPARSE_LOG_BATCH_SIZE];
+    cParseLogRing *ring = NULL, *next = NULL;
+    cParseLogSink sink = NULL;
+    void *param = NULL;
+    size_t count = 0, total = 0, i = 0;
+    int closed = 0;
+
+    cparse_log_get_sink(&sink, &param);
+
+    for (ring = __atomic_load_n(&cparse_log_rings, __ATOMIC_ACQUIRE); ring != NULL; ring = next) {
+        /* checked first, so nothing queued before the thread exited is missed */
+        closed = __atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE);
+
+        while ((count = cparse_log_take(ring, batch, CPARSE_LOG_BATCH_SIZE)) > 0) {
+            pthread_mutex_unlock(&cparse_log_lock);
+
+            for (i = 0; i < count; i++) {
+                (*sink)(&batch[i].record, param);
+            }
+
+            pthread_mutex_lock(&cparse_log_lock);
+
+            total += count;
+        }
+
+        next = ring->next;
+
+        if (closed) {
+            cparse_log_ring_free(ring);
+        }
+    }
+
+    if (total > 0 && sink == cparse_log_default_sink) {
+        fflush(stdout);
+    }
+
+    return total;
+}
+
+static void *cparse_log_writer_thread(void *arg)
+{
+    struct timespec wait;
+
+    pthread_mutex_lock(&cparse_log_lock);
+
+    while (cparse_log_async) {
+        cparse_log_begin_drain();
+        cparse_log_drain_all();
+        cparse_log_end_drain();
+
+        clock_gettime(CLOCK_REALTIME, &wait);
+
+        wait.tv_nsec += CPARSE_LOG_WRITER_INTERVAL * 1000000L;
+
+        if (wait.tv_nsec >= 1000000000L) {
+            wait.tv_sec++;
+            wait.tv_nsec -= 1000000000L;
+        }
+
+        pthread_cond_timedwait(&cparse_log_wake, &cparse_log_lock, &wait);
+    }
+
+    /* write anything left, and free the rings closed while async */
+    cparse_log_begin_drain();
+    cparse_log_drain_all();
+    cparse_log_end_drain();
+
+    pthread_mutex_unlock(&cparse_log_lock);
+
+    return NULL;
+}
+
+/* called when a thread with a ring exits */
+static void cparse_log_ring_destructor(void *value)
+{
+    cParseLogRing *ring = (cParseLogRing *)value;
+
+    pthread_mutex_lock(&cparse_log_lock);
+
+    __atomic_store_n(&ring->closed, 1, __ATOMIC_RELEASE);
+
+    /* the writer frees it once it has been drained, otherwise it is written and freed here */
+    if (!cparse_log_async) {
+        cparse_log_begin_drain();
+        cparse_log_drain_all();
+        cparse_log_end_drain();
+    }
+
+    pthread_mutex_unlock(&cparse_log_lock);
+}
+
+static void cparse_log_init()
+{
+    if (pthread_key_create(&cparse_log_key, cparse_log_ring_destructor)) {
+        fputs("cparse: unable to create log thread key\n", stderr);
+    }
+}
+
+/* gets the ring for the calling thread, creating it on first use */
+static cParseLogRing *cparse_log_ring()
+{
+    cParseLogRing *ring = pthread_getspecific(cparse_log_key);
+
+    if (ring != NULL) {
+        return ring;
+    }
+
+    ring = cparse_malloc(sizeof(cParseLogRing));
+
+    if (ring == NULL) {
+        return NULL;
+    }
+
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped = 0;
+    ring->closed = 0;
+
+    if (pthread_setspecific(cparse_log_key, ring)) {
+        cparse_free(ring);
+        return NULL;
+    }
+
+    /* pushed without the lock, so a thread never waits on the writer to log */
+    ring->next = __atomic_load_n(&cparse_log_rings, __ATOMIC_RELAXED);
 
-    if (cParseLogError > cparse_current_log_level || cparse_str_empty(format)) {
+    while (!__atomic_compare_exchange_n(&cparse_log_rings, &ring->next, ring, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        ;
+
+    return ring;
+}
+
+/* queues a message for the writer thread. never blocks, the message is dropped if the ring is full */
+static void cparse_log_enqueue(const cParseLogRecord *record, const char *const format, va_list args)
+{
+    cParseLogMessage *message = NULL;
+    cParseLogRing *ring = cparse_log_ring();
+    size_t head = 0;
+
+    if (ring == NULL) {
         return;
     }
 
-    va_start(args, format);
-    cparse_log_vargs(cParseLogError, format, args);
-    va_end(args);
+    head = ring->head;
+
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= CPARSE_LOG_RING_SIZE) {
+        __atomic_add_fetch(&ring->dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    message = &ring->messages[head & (CPARSE_LOG_RING_SIZE - 1)];
+
+    message->record = *record;
+
+    vsnprintf(message->text, CPARSE_LOG_RECORD_SIZE, format, args);
+
+    message->record.message = message->text;
+
+    /* the request path may be reused before the writer gets to it */
+    if (record->path != NULL) {
+        snprintf(message->path, CPARSE_LOG_PATH_SIZE, "%s", record->path);
+
+        message->record.path = message->path;
+    }
+
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
 }
 
-void cparse_log_warn(const char *const format, ...)
+/* stops the writer once it has written everything queued. called with the control lock held */
+static void cparse_log_stop_writer()
 {
-    va_list args;
+    pthread_mutex_lock(&cparse_log_lock);
 
-    if (cParseLogWarn > cparse_current_log_level || cparse_str_empty(format)) {
+    if (!cparse_log_async) {
+        pthread_mutex_unlock(&cparse_log_lock);
         return;
     }
 
-    va_start(args, format);
-    cparse_log_vargs(cParseLogWarn, format, args);
-    va_end(args);
+    __atomic_store_n(&cparse_log_async, 0, __ATOMIC_RELEASE);
+
+    pthread_cond_signal(&cparse_log_wake);
+
+    pthread_mutex_unlock(&cparse_log_lock);
+
+    /* the writer drains the rings before exiting, the control lock keeps another from starting meanwhile */
+    pthread_join(cparse_log_writer, NULL);
 }
 
-void cparse_log_info(const char *const format, ...)
+void cparse_enable_async_logging(bool value)
 {
-    va_list args;
+    pthread_once(&cparse_log_once, cparse_log_init);
+
+    pthread_mutex_lock(&cparse_log_control);
 
-    if (cParseLogInfo > cparse_current_log_level || cparse_str_empty(format)) {
+    if (!value) {
+        cparse_log_stop_writer();
+
+        pthread_mutex_unlock(&cparse_log_control);
         return;
     }
 
-    va_start(args, format);
-    cparse_log_vargs(cParseLogInfo, format, args);
-    va_end(args);
+    pthread_mutex_lock(&cparse_log_lock);
+
+    if (!cparse_log_async) {
+        __atomic_store_n(&cparse_log_async, 1, __ATOMIC_RELEASE);
+
+        if (pthread_create(&cparse_log_writer, NULL, cparse_log_writer_thread, NULL)) {
+            __atomic_store_n(&cparse_log_async, 0, __ATOMIC_RELEASE);
+        }
+    }
+
+    pthread_mutex_unlock(&cparse_log_lock);
+
+    pthread_mutex_unlock(&cparse_log_control);
+}
+
+unsigned long cparse_log_dropped_count()
+{
+    unsigned long count = 0;
+    cParseLogRing *ring = NULL;
+
+    pthread_mutex_lock(&cparse_log_lock);
+
+    count = cparse_log_dropped;
+
+    for (ring = __atomic_load_n(&cparse_log_rings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->next) {
+        count += __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_unlock(&cparse_log_lock);
+
+    return count;
+}
+
+void cparse_log_cleanup()
+{
+    cParseLogRing *ring = NULL;
+
+    pthread_once(&cparse_log_once, cparse_log_init);
+
+    pthread_mutex_lock(&cparse_log_control);
+
+    cparse_log_stop_writer();
+
+    pthread_mutex_lock(&cparse_log_lock);
+
+    cparse_log_begin_drain();
+
+    ring = pthread_getspecific(cparse_log_key);
+
+    /* freed by the drain below, like the ring of an exited thread */
+    if (ring != NULL) {
+        pthread_setspecific(cparse_log_key, NULL);
+
+        __atomic_store_n(&ring->closed, 1, __ATOMIC_RELEASE);
+    }
+
+    /* other threads free their own ring when they exit */
+    cparse_log_drain_all();
+
+    cparse_log_end_drain();
+
+    pthread_mutex_unlock(&cparse_log_lock);
+
+    pthread_mutex_unlock(&cparse_log_control);
+}
+
+static void cparse_log_vargs(cParseLogRecord *record, const char *const format, va_list args)
+{
+    char buf[CPARSE_LOG_BUF_SIZE] = {0};
+    char *message = buf;
+    cParseLogSink sink = NULL;
+    void *param = NULL;
+    va_list copy;
+    int size = 0;
+
+#if defined(HAVE_DLADDR) && defined(CPARSE_LOG_CALLERS)
+    char function[CPARSE_BUF_SIZE + 1] = {0};
+    const char *caller = "unk";
+    void *callstack[4];
+    Dl_info info;
+#endif
+
+    if (cparse_str_empty(format)) {
+        return;
+    }
+
+    if (record->function == NULL) {
+        record->function = "unk";
+    }
+
+    record->timestamp = time(0);
+
+    if (__atomic_load_n(&cparse_log_async, __ATOMIC_ACQUIRE)) {
+        cparse_log_enqueue(record, format, args);
+        return;
+    }
+
+#if defined(HAVE_DLADDR) && defined(CPARSE_LOG_CALLERS)
+    /* debug builds can also show who called the logging function. slow, it takes the loader lock */
+    if (backtrace(callstack, 4) > 3 && dladdr(callstack[3], &info) && info.dli_sname) {
+        caller = info.dli_sname;
+    }
+
+    snprintf(function, CPARSE_BUF_SIZE, "%s <- %s", record->function, caller);
+
+    record->function = function;
+#endif
+
+    va_copy(copy, args);
+
+    size = vsnprintf(buf, CPARSE_LOG_BUF_SIZE, format, copy);
+
+    va_end(copy);
+
+    /* only allocate for long messages */
+    if (size >= CPARSE_LOG_BUF_SIZE) {
+        message = cparse_malloc(size + 1);
+
+        if (message != NULL) {
+            vsnprintf(message, size + 1, format, args);
+        } else {
+            message = buf;
+        }
+    }
+
+    record->message = message;
+
+    cparse_log_get_sink(&sink, &param);
+
+    (*sink)(record, param);
+
+    if (sink == cparse_log_default_sink) {
+        fflush(stdout);
+    }
+
+    if (message != buf) {
+        cparse_free(message);
+    }
 }
 
-void cparse_log_debug(const char *const format, ...)
+void cparse_log_write(cParseLogLevel level, const char *func, const char *const format, ...)
 {
+    cParseLogRecord record = {0};
     va_list args;
 
-    if (cParseLogDebug > cparse_current_log_level || cparse_str_empty(format)) {
+    if (!cparse_log_enabled(level)) {
         return;
     }
 
+    record.level = level;
+    record.function = func;
+
     va_start(args, format);
-    cparse_log_vargs(cParseLogDebug, format, args);
+    cparse_log_vargs(&record, format, args);
     va_end(args);
 }
 
-void cparse_log_trace(const char *const format, ...)
+void cparse_log_write_request(cParseLogRecord *record, const char *const format, ...)
 {
     va_list args;
 
-    if (cParseLogTrace > cparse_current_log_level || cparse_str_empty(format)) {
+    if (record == NULL || !cparse_log_enabled(record->level)) {
         return;
     }
 
     va_start(args, format);
-    cparse_log_vargs(cParseLogTrace, format, args);
+    cparse_log_vargs(record, format, args);
     va_end(args);
 }
 
-void cparse_log_set_error(cParseError **error, const char *const format, ...)
+void cparse_log_write_error(cParseError **error, const char *func, const char *const format, ...)
 {
+    cParseLogRecord record = {0};
     va_list args;
 
     if (cparse_str_empty(format)) {
         return;
     }
 
-    va_start(args, format);
-
     if (error) {
         char buf[CPARSE_BUF_SIZE + 1] = {0};
+
+        va_start(args, format);
         vsnprintf(buf, CPARSE_BUF_SIZE, format, args);
+        va_end(args);
+
         *error = cparse_error_with_message(buf);
     }
 
-    if (cParseLogError > cparse_current_log_level) {
-        va_end(args);
+    if (!cparse_log_enabled(cParseLogError)) {
         return;
     }
 
-    cparse_log_vargs(cParseLogError, format, args);
+    record.level = cParseLogError;
+    record.function = func;
+
+    va_start(args, format);
+    cparse_log_vargs(&record, format, args);
     va_end(args);
 }
 
@@ -3,26 +3,66 @@
 
 
 #include <string.h>
+#include <cparse/parse.h>
+#include <cparse/error.h>
 
 #ifndef __attribute__
 #define __attribute__(x)
 #endif
 
-void cparse_log_error(const char *const format, ...) __attribute__((format(printf, 1, 2)));
+/* messages above this level are compiled out */
+#ifndef CPARSE_MIN_LOG_LEVEL
+#define CPARSE_MIN_LOG_LEVEL cParseLogTrace
+#endif
+
+extern cParseLogLevel cparse_current_log_level;
+
+/* tests if a level is logged, before evaluating any arguments */
+#define cparse_log_enabled(level) ((level) <= CPARSE_MIN_LOG_LEVEL && (level) <= cparse_current_log_level)
 
-void cparse_log_warn(const char *const format, ...) __attribute__((format(printf, 1, 2)));
+#define cparse_log_at(level, ...)                           \
+    do {                                                    \
+        if (cparse_log_enabled(level)) {                    \
+            cparse_log_write(level, __func__, __VA_ARGS__); \
+        }                                                   \
+    } while (0)
 
-void cparse_log_info(const char *const format, ...) __attribute__((format(printf, 1, 2)));
+#define cparse_log_error(...) cparse_log_at(cParseLogError, __VA_ARGS__)
 
-void cparse_log_debug(const char *const format, ...) __attribute__((format(printf, 1, 2)));
+#define cparse_log_warn(...) cparse_log_at(cParseLogWarn, __VA_ARGS__)
 
-void cparse_log_trace(const char *const format, ...) __attribute__((format(printf, 1, 2)));
+#define cparse_log_info(...) cparse_log_at(cParseLogInfo, __VA_ARGS__)
 
+#define cparse_log_debug(...) cparse_log_at(cParseLogDebug, __VA_ARGS__)
+
+#define cparse_log_trace(...) cparse_log_at(cParseLogTrace, __VA_ARGS__)
 
 #define cparse_log_errno(errnum) cparse_log_error("%s:%d %s (%d)", __FILE__, __LINE__, strerror(errnum), errnum)
 
-void cparse_log_set_error(cParseError **error, const char *const format, ...) __attribute__((format(printf, 2, 3)));
+/* sets an error and logs it */
+#define cparse_log_set_error(error, ...) cparse_log_write_error(error, __func__, __VA_ARGS__)
+
+/* sets a shared error for a code without allocating, and logs it if enabled */
+#define cparse_log_set_error_code(error, code)                                        \
+    do {                                                                              \
+        if (error) {                                                                  \
+            *(error) = cparse_error_with_code(code);                                  \
+        }                                                                             \
+        cparse_log_error("%s (%d)", cparse_error_code_message(code), (int)(code));    \
+    } while (0)
+
+/* writes a log message, use the level macros instead */
+void cparse_log_write(cParseLogLevel level, const char *func, const char *const format, ...) __attribute__((format(printf, 3, 4)));
+
+/* writes a log message with the request fields of a record */
+void cparse_log_write_request(cParseLogRecord *record, const char *const format, ...) __attribute__((format(printf, 2, 3)));
+
+void cparse_log_write_error(cParseError **error, const char *func, const char *const format, ...)
+    __attribute__((format(printf, 3, 4)));
 
 void cparse_log_set_errno(cParseError **error, int errnum);
 
+/* stops async logging and frees the calling thread's log buffer */
+void cparse_log_cleanup();
+
 #endif
@@ -0,0 +1,227 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <cparse/memory.h>
+
+/* the size of each allocation is kept before it, padded to keep the alignment of malloc */
+typedef union {
+    size_t size;
+    long double align;
+    void *ptr;
+    long long value;
+} cParseMemoryHeader;
+
+static void *cparse_default_allocate(size_t size, void *param)
+{
+    return malloc(size);
+}
+
+static void *cparse_default_reallocate(void *ptr, size_t size, void *param)
+{
+    return realloc(ptr, size);
+}
+
+static void cparse_default_release(void *ptr, void *param)
+{
+    free(ptr);
+}
+
+static cParseAllocator cparse_allocator = {cparse_default_allocate, cparse_default_reallocate, cparse_default_release, NULL};
+
+static size_t cparse_memory_limit = 0;
+
+static cParseMemoryStats cparse_memory = {0, 0, 0, 0, 0};
+
+/* counts bytes as allocated, unless it goes over the limit */
+static bool cparse_memory_reserve(size_t size)
+{
+    size_t live = __atomic_add_fetch(&cparse_memory.liveBytes, size, __ATOMIC_RELAXED);
+    size_t limit = __atomic_load_n(&cparse_memory_limit, __ATOMIC_RELAXED);
+    size_t peak = __atomic_load_n(&cparse_memory.peakBytes, __ATOMIC_RELAXED);
+
+    if (limit > 0 && live > limit) {
+        __atomic_sub_fetch(&cparse_memory.liveBytes, size, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&cparse_memory.failures, 1, __ATOMIC_RELAXED);
+        errno = ENOMEM;
+        return false;
+    }
+
+    while (live > peak && !__atomic_compare_exchange_n(&cparse_memory.peakBytes, &peak, live, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+
+    return true;
+}
+
+static void cparse_memory_unreserve(size_t size)
+{
+    __atomic_sub_fetch(&cparse_memory.liveBytes, size, __ATOMIC_RELAXED);
+}
+
+bool cparse_set_allocator(const cParseAllocator *allocator)
+{
+    if (__atomic_load_n(&cparse_memory.liveAllocations, __ATOMIC_RELAXED) > 0) {
+        errno = EBUSY;
+        return false;
+    }
+
+    if (allocator == NULL) {
+        cparse_allocator.allocate = cparse_default_allocate;
+        cparse_allocator.reallocate = cparse_default_reallocate;
+        cparse_allocator.release = cparse_default_release;
+        cparse_allocator.param = NULL;
+    } else {
+        cparse_allocator = *allocator;
+    }
+
+    return true;
+}
+
+void cparse_set_memory_limit(size_t bytes)
+{
+    __atomic_store_n(&cparse_memory_limit, bytes, __ATOMIC_RELAXED);
+}
+
+void cparse_memory_stats(cParseMemoryStats *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
+    stats->liveBytes = __atomic_load_n(&cparse_memory.liveBytes, __ATOMIC_RELAXED);
+    stats->peakBytes = __atomic_load_n(&cparse_memory.peakBytes, __ATOMIC_RELAXED);
+    stats->liveAllocations = __atomic_load_n(&cparse_memory.liveAllocations, __ATOMIC_RELAXED);
+    stats->allocations = __atomic_load_n(&cparse_memory.allocations, __ATOMIC_RELAXED);
+    stats->failures = __atomic_load_n(&cparse_memory.failures, __ATOMIC_RELAXED);
+}
+
+void *cparse_malloc(size_t size)
+{
+    cParseMemoryHeader *header = NULL;
+
+    if (size > SIZE_MAX - sizeof(cParseMemoryHeader)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    if (!cparse_memory_reserve(size)) {
+        return NULL;
+    }
+
+    header = cparse_allocator.allocate(sizeof(cParseMemoryHeader) + size, cparse_allocator.param);
+
+    if (header == NULL) {
+        cparse_memory_unreserve(size);
+        __atomic_add_fetch(&cparse_memory.failures, 1, __ATOMIC_RELAXED);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    header->size = size;
+
+    __atomic_add_fetch(&cparse_memory.allocations, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&cparse_memory.liveAllocations, 1, __ATOMIC_RELAXED);
+
+    return header + 1;
+}
+
+void *cparse_calloc(size_t count, size_t size)
+{
+    void *ptr = NULL;
+
+    if (size > 0 && count > SIZE_MAX / size) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    ptr = cparse_malloc(count * size);
+
+    if (ptr != NULL) {
+        memset(ptr, 0, count * size);
+    }
+
+    return ptr;
+}
+
+void *cparse_realloc(void *ptr, size_t size)
+{
+    cParseMemoryHeader *header = NULL, *resized = NULL;
+
+    if (ptr == NULL) {
+        return cparse_malloc(size);
+    }
+
+    if (size > SIZE_MAX - sizeof(cParseMemoryHeader)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    header = (cParseMemoryHeader *)ptr - 1;
+
+    /* count growth before it happens so the limit holds */
+    if (size > header->size && !cparse_memory_reserve(size - header->size)) {
+        return NULL;
+    }
+
+    resized = cparse_allocator.reallocate(header, sizeof(cParseMemoryHeader) + size, cparse_allocator.param);
+
+    if (resized == NULL) {
+        if (size > header->size) {
+            cparse_memory_unreserve(size - header->size);
+        }
+        __atomic_add_fetch(&cparse_memory.failures, 1, __ATOMIC_RELAXED);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    if (size < resized->size) {
+        cparse_memory_unreserve(resized->size - size);
+    }
+
+    resized->size = size;
+
+    __atomic_add_fetch(&cparse_memory.allocations, 1, __ATOMIC_RELAXED);
+
+    return resized + 1;
+}
+
+char *cparse_strdup(const char *str)
+{
+    size_t size = 0;
+    char *copy = NULL;
+
+    if (str == NULL) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    size = strlen(str) + 1;
+
+    copy = cparse_malloc(size);
+
+    if (copy != NULL) {
+        memcpy(copy, str, size);
+    }
+
+    return copy;
+}
+
+void cparse_free(void *ptr)
+{
+    cParseMemoryHeader *header = NULL;
+
+    if (ptr == NULL) {
+        return;
+    }
+
+    header = (cParseMemoryHeader *)ptr - 1;
+
+    cparse_memory_unreserve(header->size);
+
+    __atomic_sub_fetch(&cparse_memory.liveAllocations, 1, __ATOMIC_RELAXED);
+
+    cparse_allocator.release(header, cparse_allocator.param);
+}
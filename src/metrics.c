@@ -0,0 +1,270 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <pthread.h>
+#include <cparse/util.h>
+#include <cparse/memory.h>
+#include "metrics.h"
+#include "protocol.h"
+#include "log.h"
+
+/* the upper bounds of the histogram buckets in seconds */
+static const double cparse_metrics_buckets[CPARSE_METRICS_BUCKETS] = {0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+                                                                      0.1,   0.25,   0.5,   1,    2.5,   5};
+
+static const char *const cparse_metrics_endpoint_names[] = {"objects", "users", "login", "functions", "batch", "other"};
+
+static const char *const cparse_metrics_timing_names[] = {"dns", "connect", "tls", "first_byte", "total"};
+
+static pthread_mutex_t cparse_metrics_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static cParseMetrics cparse_metrics;
+
+/* a growing string for the export */
+typedef struct {
+    char *text;
+    size_t size;
+    size_t capacity;
+} cParseMetricsBuffer;
+
+cParseEndpoint cparse_metrics_endpoint(const char *path)
+{
+    if (cparse_str_empty(path)) {
+        return cParseEndpointOther;
+    }
+
+    if (!cparse_str_prefix(CPARSE_OBJECTS_PATH, path)) {
+        return cParseEndpointObjects;
+    }
+
+    if (!strcmp(path, "login")) {
+        return cParseEndpointLogin;
+    }
+
+    if (!cparse_str_prefix(CPARSE_USERS_PATH, path)) {
+        return cParseEndpointUsers;
+    }
+
+    if (!cparse_str_prefix(CPARSE_CLOUD_FUNCTIONS_PATH, path)) {
+        return cParseEndpointFunctions;
+    }
+
+    if (!cparse_str_prefix(CPARSE_BATCH_REQUEST_URI, path)) {
+        return cParseEndpointBatch;
+    }
+
+    return cParseEndpointOther;
+}
+
+static void cparse_metrics_observe(cParseHistogram *histogram, double value)
+{
+    size_t i;
+
+    for (i = 0; i < CPARSE_METRICS_BUCKETS; i++) {
+        if (value <= cparse_metrics_buckets[i]) {
+            break;
+        }
+    }
+
+    histogram->buckets[i]++;
+    histogram->count++;
+    histogram->sum += value;
+}
+
+void cparse_metrics_record(const cParseMetricsSample *sample)
+{
+    cParseEndpointMetrics *metrics = NULL;
+    size_t i;
+
+    if (sample == NULL || sample->endpoint >= cParseEndpointCount) {
+        cparse_log_errno(EINVAL);
+        return;
+    }
+
+    pthread_mutex_lock(&cparse_metrics_lock);
+
+    metrics = &cparse_metrics.endpoints[sample->endpoint];
+
+    metrics->requests++;
+
+    if (sample->error) {
+        metrics->errors++;
+    }
+
+    metrics->bytesSent += sample->bytesSent;
+    metrics->bytesReceived += sample->bytesReceived;
+
+    for (i = 0; i < cParseTimingCount; i++) {
+        cparse_metrics_observe(&metrics->timings[i], sample->timings[i]);
+    }
+
+    pthread_mutex_unlock(&cparse_metrics_lock);
+}
+
+void cparse_metrics_snapshot(cParseMetrics *metrics)
+{
+    if (metrics == NULL) {
+        cparse_log_errno(EINVAL);
+        return;
+    }
+
+    pthread_mutex_lock(&cparse_metrics_lock);
+
+    *metrics = cparse_metrics;
+
+    pthread_mutex_unlock(&cparse_metrics_lock);
+}
+
+void cparse_metrics_reset()
+{
+    pthread_mutex_lock(&cparse_metrics_lock);
+
+    memset(&cparse_metrics, 0, sizeof(cparse_metrics));
+
+    pthread_mutex_unlock(&cparse_metrics_lock);
+}
+
+double cparse_metrics_bucket(size_t index)
+{
+    return index < CPARSE_METRICS_BUCKETS ? cparse_metrics_buckets[index] : 0;
+}
+
+const char *cparse_metrics_endpoint_name(cParseEndpoint endpoint)
+{
+    return endpoint < cParseEndpointCount ? cparse_metrics_endpoint_names[endpoint] : NULL;
+}
+
+const char *cparse_metrics_timing_name(cParseTiming timing)
+{
+    return timing < cParseTimingCount ? cparse_metrics_timing_names[timing] : NULL;
+}
+
+static bool cparse_metrics_printf(cParseMetricsBuffer *buf, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+static bool cparse_metrics_printf(cParseMetricsBuffer *buf, const char *format, ...)
+{
+    va_list args;
+    int size = 0;
+
+    for (;;) {
+        va_start(args, format);
+        size = vsnprintf(buf->text + buf->size, buf->capacity - buf->size, format, args);
+        va_end(args);
+
+        if (size < 0) {
+            return false;
+        }
+
+        if (buf->size + size < buf->capacity) {
+            buf->size += size;
+            return true;
+        }
+
+        {
+            size_t capacity = buf->capacity * 2 + size;
+            char *text = cparse_realloc(buf->text, capacity);
+
+            if (text == NULL) {
+                cparse_log_errno(ENOMEM);
+                return false;
+            }
+
+            buf->text = text;
+            buf->capacity = capacity;
+        }
+    }
+}
+
+/* writes a counter with a value for every endpoint */
+static bool cparse_metrics_counter(cParseMetricsBuffer *buf, const char *name, const char *help,
+                                   const unsigned long long values[cParseEndpointCount])
+{
+    size_t i;
+
+    if (!cparse_metrics_printf(buf, "# HELP %s %s\n# TYPE %s counter\n", name, help, name)) {
+        return false;
+    }
+
+    for (i = 0; i < cParseEndpointCount; i++) {
+        if (!cparse_metrics_printf(buf, "%s{endpoint=\"%s\"} %llu\n", name, cparse_metrics_endpoint_names[i], values[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+char *cparse_metrics_to_prometheus()
+{
+    static const char *const name = "cparse_request_duration_seconds";
+    cParseMetricsBuffer buf = {NULL, 0, 0};
+    cParseMetrics metrics;
+    unsigned long long requests[cParseEndpointCount], errors[cParseEndpointCount];
+    unsigned long long sent[cParseEndpointCount], received[cParseEndpointCount];
+    size_t i, j, k;
+
+    buf.capacity = 4096;
+    buf.text = cparse_malloc(buf.capacity);
+
+    if (buf.text == NULL) {
+        cparse_log_errno(ENOMEM);
+        return NULL;
+    }
+
+    cparse_metrics_snapshot(&metrics);
+
+    for (i = 0; i < cParseEndpointCount; i++) {
+        requests[i] = metrics.endpoints[i].requests;
+        errors[i] = metrics.endpoints[i].errors;
+        sent[i] = metrics.endpoints[i].bytesSent;
+        received[i] = metrics.endpoints[i].bytesReceived;
+    }
+
+    if (!cparse_metrics_counter(&buf, "cparse_requests_total", "Requests sent.", requests) ||
+        !cparse_metrics_counter(&buf, "cparse_request_errors_total", "Requests that failed or returned an HTTP error.", errors) ||
+        !cparse_metrics_counter(&buf, "cparse_request_bytes_total", "Bytes sent in requests.", sent) ||
+        !cparse_metrics_counter(&buf, "cparse_response_bytes_total", "Bytes received in responses.", received)) {
+        cparse_free(buf.text);
+        return NULL;
+    }
+
+    if (!cparse_metrics_printf(&buf, "# HELP %s Time taken by each phase of a request.\n# TYPE %s histogram\n", name, name)) {
+        cparse_free(buf.text);
+        return NULL;
+    }
+
+    for (i = 0; i < cParseEndpointCount; i++) {
+        for (j = 0; j < cParseTimingCount; j++) {
+            const cParseHistogram *histogram = &metrics.endpoints[i].timings[j];
+            const char *endpoint = cparse_metrics_endpoint_names[i];
+            const char *phase = cparse_metrics_timing_names[j];
+            unsigned long cumulative = 0;
+
+            /* prometheus buckets are cumulative */
+            for (k = 0; k < CPARSE_METRICS_BUCKETS; k++) {
+                cumulative += histogram->buckets[k];
+
+                if (!cparse_metrics_printf(&buf, "%s_bucket{endpoint=\"%s\",phase=\"%s\",le=\"%g\"} %lu\n", name, endpoint, phase,
+                                           cparse_metrics_buckets[k], cumulative)) {
+                    cparse_free(buf.text);
+                    return NULL;
+                }
+            }
+
+            if (!cparse_metrics_printf(&buf, "%s_bucket{endpoint=\"%s\",phase=\"%s\",le=\"+Inf\"} %lu\n", name, endpoint, phase,
+                                       histogram->count) ||
+                !cparse_metrics_printf(&buf, "%s_sum{endpoint=\"%s\",phase=\"%s\"} %g\n", name, endpoint, phase, histogram->sum) ||
+                !cparse_metrics_printf(&buf, "%s_count{endpoint=\"%s\",phase=\"%s\"} %lu\n", name, endpoint, phase, histogram->count)) {
+                cparse_free(buf.text);
+                return NULL;
+            }
+        }
+    }
+
+    return buf.text;
+}
@@ -0,0 +1,25 @@
+#ifndef CPARSE_METRICS_PRIVATE_H_
+#define CPARSE_METRICS_PRIVATE_H_
+
+#include <cparse/metrics.h>
+
+/*! the measurements of a single request */
+typedef struct {
+    cParseEndpoint endpoint;
+    bool error;
+    size_t bytesSent;
+    size_t bytesReceived;
+    double timings[cParseTimingCount];
+} cParseMetricsSample;
+
+BEGIN_DECL
+
+/*! gets the endpoint a request path belongs to */
+cParseEndpoint cparse_metrics_endpoint(const char *path);
+
+/*! adds the measurements of a request */
+void cparse_metrics_record(const cParseMetricsSample *sample);
+
+END_DECL
+
+#endif
@@ -8,6 +8,8 @@
 #include <cparse/error.h>
 #include <cparse/json.h>
 #include <cparse/role.h>
+#include <cparse/query.h>
+#include <cparse/memory.h>
 #include <stdio.h>
 #include "client.h"
 #include "request.h"
@@ -66,7 +68,7 @@ static void *cparse_object_background_action(void *argument)
         (*arg->cleanup)(arg->obj);
     }
 
-    free(arg);
+    cparse_free(arg);
 
     pthread_mutex_lock(&cparse_thread_count_mutex);
     cparse_thread_count--;
@@ -87,7 +89,7 @@ bool cparse_object_run_in_background(cParseObject *obj, cParseObjectAction actio
         return false;
     }
 
-    arg = malloc(sizeof(cParseObjectThread));
+    arg = cparse_malloc(sizeof(cParseObjectThread));
 
     if (arg == NULL) {
         cparse_log_errno(ENOMEM);
@@ -123,7 +125,7 @@ bool cparse_object_run_in_background(cParseObject *obj, cParseObjectAction actio
 
 void cparse_object_set_request_includes(cParseObject *obj, cParseRequest *request)
 {
-    char types[CPARSE_BUF_SIZE + 1] = {0};
+    char *types = NULL;
 
     if (obj == NULL || request == NULL) {
         cparse_log_errno(EINVAL);
@@ -142,14 +144,17 @@ void cparse_object_set_request_includes(cParseObject *obj, cParseRequest *reques
         typeVal = cparse_json_get_string(val, CPARSE_KEY_TYPE);
 
         if (typeVal && !strcmp(typeVal, CPARSE_TYPE_POINTER)) {
-            strncat(types, ",", CPARSE_BUF_SIZE);
-            strncat(types, key, CPARSE_BUF_SIZE);
+            if (!cparse_build_string(&types, ",", key, NULL)) {
+                return;
+            }
         }
     }
     cparse_json_foreach_end;
 
-    if (types[0] != 0) {
+    if (types != NULL) {
         cparse_request_add_data(request, "include", &types[1]);
+
+        cparse_free(types);
     }
 }
 
@@ -163,6 +168,8 @@ cParseRequest *cparse_object_create_request(cParseObject *obj, cParseHttpRequest
         return NULL;
     }
 
+    cparse_object_materialize(obj);
+
     if (method != cParseHttpRequestMethodPost && !cparse_str_empty(obj->objectId)) {
         snprintf(buf, CPARSE_BUF_SIZE, "%s/%s", obj->urlPath, obj->objectId);
     } else {
@@ -174,10 +181,77 @@ cParseRequest *cparse_object_create_request(cParseObject *obj, cParseHttpRequest
     return request;
 }
 
+/* sets the object id, a NULL id reference copies the value */
+static void cparse_object_set_id(cParseObject *obj, const char *value, cParseJson *ref)
+{
+    if (obj->objectIdRef) {
+        cparse_json_free(obj->objectIdRef);
+        obj->objectIdRef = NULL;
+    } else if (obj->objectId) {
+        cparse_free(obj->objectId);
+    }
+
+    if (ref != NULL) {
+        /* points into the json value */
+        obj->objectIdRef = ref;
+        obj->objectId = (char *)cparse_json_to_string(ref);
+    } else {
+        obj->objectId = value ? cparse_strdup(value) : NULL;
+    }
+}
+
+/* replaces an unparsed date value */
+static void cparse_object_set_date_ref(cParseJson **date, cParseJson *ref)
+{
+    if (*date) {
+        cparse_json_free(*date);
+    }
+
+    *date = ref;
+}
+
+/* parses a date value if it has not been already */
+static time_t cparse_object_resolve_date(cParseJson **date, time_t *value)
+{
+    if (*date != NULL) {
+        *value = cparse_date_time(cparse_json_to_string(*date));
+
+        cparse_json_free(*date);
+
+        *date = NULL;
+    }
+
+    return *value;
+}
+
+/* removes the special keys from json and keeps their values on the object without copying */
+static void cparse_object_take_keys(cParseObject *obj, cParseJson *json)
+{
+    cParseJson *value = cparse_json_remove_and_get(json, CPARSE_KEY_OBJECT_ID);
+
+    if (value != NULL) {
+        cparse_object_set_id(obj, NULL, value);
+    }
+
+    value = cparse_json_remove_and_get(json, CPARSE_KEY_CREATED_AT);
+
+    if (value != NULL) {
+        cparse_object_set_date_ref(&obj->createdAtRef, value);
+    }
+
+    value = cparse_json_remove_and_get(json, CPARSE_KEY_UPDATED_AT);
+
+    if (value != NULL) {
+        cparse_object_set_date_ref(&obj->updatedAtRef, value);
+    }
+
+    cparse_json_remove(json, CPARSE_KEY_CLASS_NAME);
+}
+
 /* initializers */
 cParseObject *cparse_object_new()
 {
-    cParseObject *obj = malloc(sizeof(cParseObject));
+    cParseObject *obj = cparse_malloc(sizeof(cParseObject));
 
     if (obj == NULL) {
         cparse_log_errno(ENOMEM);
@@ -189,6 +263,10 @@ cParseObject *cparse_object_new()
     obj->objectId = NULL;
     obj->createdAt = 0;
     obj->updatedAt = 0;
+    obj->objectIdRef = NULL;
+    obj->createdAtRef = NULL;
+    obj->updatedAtRef = NULL;
+    obj->lazy = false;
     obj->attributes = cparse_json_new();
 
     return obj;
@@ -201,9 +279,14 @@ void cparse_object_copy(cParseObject *obj, cParseObject *other)
         return;
     }
 
+    cparse_object_materialize(other);
+    cparse_object_materialize(obj);
+
     cparse_replace_str(&obj->className, other->className);
     cparse_replace_str(&obj->urlPath, other->urlPath);
-    cparse_replace_str(&obj->objectId, other->objectId);
+    cparse_object_set_id(obj, other->objectId, other->objectIdRef ? cparse_json_new_reference(other->objectIdRef) : NULL);
+    cparse_object_set_date_ref(&obj->createdAtRef, other->createdAtRef ? cparse_json_new_reference(other->createdAtRef) : NULL);
+    cparse_object_set_date_ref(&obj->updatedAtRef, other->updatedAtRef ? cparse_json_new_reference(other->updatedAtRef) : NULL);
     obj->createdAt = other->createdAt;
     obj->updatedAt = other->updatedAt;
 
@@ -226,7 +309,7 @@ cParseObject *cparse_object_with_class_name(const char *className)
         return NULL;
     }
 
-    obj->className = strdup(className);
+    obj->className = cparse_strdup(className);
 
     if (obj->className == NULL) {
         cparse_object_free(obj);
@@ -235,7 +318,7 @@ cParseObject *cparse_object_with_class_name(const char *className)
 
     snprintf(buf, CPARSE_BUF_SIZE, "%s%s", CPARSE_OBJECTS_PATH, className);
 
-    obj->urlPath = strdup(buf);
+    obj->urlPath = cparse_strdup(buf);
 
     if (obj->urlPath == NULL) {
         cparse_object_free(obj);
@@ -260,25 +343,88 @@ cParseObject *cparse_object_from_query(cParseQuery *query, cParseJson *json)
         return NULL;
     }
 
-    obj->className = strdup(query->className);
+    obj->className = cparse_strdup(query->className);
 
     if (obj->className == NULL) {
         cparse_object_free(obj);
         return NULL;
     }
 
-    obj->urlPath = strdup(query->urlPath);
+    obj->urlPath = cparse_strdup(query->urlPath);
 
     if (obj->urlPath == NULL) {
         cparse_object_free(obj);
         return NULL;
     }
 
-    cparse_object_merge_json(obj, json);
+    if (query->lazy) {
+        /* just reference the result until needed */
+        cparse_json_free(obj->attributes);
+        obj->attributes = cparse_json_new_reference(json);
+        obj->lazy = true;
+    } else {
+        cparse_object_merge_json(obj, json);
+    }
 
     return obj;
 }
 
+void cparse_object_materialize(cParseObject *obj)
+{
+    cParseJson *result = NULL;
+
+    if (obj == NULL || !obj->lazy) {
+        return;
+    }
+
+    obj->lazy = false;
+
+    /* the result is still part of the query response, so changes go to a copy of its keys */
+    result = obj->attributes;
+
+    obj->attributes = cparse_json_new();
+
+    cparse_json_copy(obj->attributes, result, true);
+
+    cparse_json_free(result);
+
+    cparse_object_take_keys(obj, obj->attributes);
+}
+
+/* tests for a key a lazy result still holds, but that is never an attribute */
+static bool cparse_object_is_hidden_key(cParseObject *obj, const char *key)
+{
+    if (!obj->lazy || key == NULL) {
+        return false;
+    }
+
+    return !strcmp(key, CPARSE_KEY_OBJECT_ID) || !strcmp(key, CPARSE_KEY_CREATED_AT) || !strcmp(key, CPARSE_KEY_UPDATED_AT) ||
+           !strcmp(key, CPARSE_KEY_CLASS_NAME);
+}
+
+void cparse_object_adopt_json(cParseObject *obj, cParseJson *json)
+{
+    if (obj == NULL || json == NULL) {
+        cparse_log_errno(EINVAL);
+        cparse_json_free(json);
+        return;
+    }
+
+    cparse_object_materialize(obj);
+
+    cparse_object_take_keys(obj, json);
+
+    if (cparse_json_num_keys(obj->attributes) == 0) {
+        cparse_json_free(obj->attributes);
+
+        obj->attributes = json;
+    } else {
+        cparse_json_copy(obj->attributes, json, true);
+
+        cparse_json_free(json);
+    }
+}
+
 cParseObject *cparse_object_with_class_data(const char *className, cParseJson *attributes)
 {
     cParseObject *obj = NULL;
@@ -313,15 +459,15 @@ void cparse_object_free(cParseObject *obj)
     cparse_json_free(obj->attributes);
 
     if (obj->className) {
-        free(obj->className);
+        cparse_free(obj->className);
     }
     if (obj->urlPath) {
-        free(obj->urlPath);
-    }
-    if (obj->objectId) {
-        free(obj->objectId);
+        cparse_free(obj->urlPath);
     }
-    free(obj);
+    cparse_object_set_id(obj, NULL, NULL);
+    cparse_object_set_date_ref(&obj->createdAtRef, NULL);
+    cparse_object_set_date_ref(&obj->updatedAtRef, NULL);
+    cparse_free(obj);
 }
 
 /* getters/setters */
@@ -333,6 +479,8 @@ size_t cparse_object_sizeof()
 
 const char *cparse_object_id(cParseObject *obj)
 {
+    cparse_object_materialize(obj);
+
     return !obj ? NULL : obj->objectId;
 }
 
@@ -343,11 +491,23 @@ const char *cparse_object_class_name(cParseObject *obj)
 
 time_t cparse_object_created_at(cParseObject *obj)
 {
-    return !obj ? 0 : obj->createdAt;
+    if (obj == NULL) {
+        return 0;
+    }
+
+    cparse_object_materialize(obj);
+
+    return cparse_object_resolve_date(&obj->createdAtRef, &obj->createdAt);
 }
 time_t cparse_object_updated_at(cParseObject *obj)
 {
-    return !obj ? 0 : obj->updatedAt;
+    if (obj == NULL) {
+        return 0;
+    }
+
+    cparse_object_materialize(obj);
+
+    return cparse_object_resolve_date(&obj->updatedAtRef, &obj->updatedAt);
 }
 
 cParseJson *cparse_object_acl(cParseObject *obj)
@@ -361,6 +521,8 @@ cParseJson *cparse_object_acl(cParseObject *obj)
 
 bool cparse_object_exists(cParseObject *obj)
 {
+    cparse_object_materialize(obj);
+
     return obj && !cparse_str_empty(obj->objectId);
 }
 
@@ -377,7 +539,7 @@ bool cparse_object_delete(cParseObject *obj, cParseError **error)
     }
 
     if (!cparse_object_exists(obj)) {
-        cparse_log_set_error(error, "Object has no id");
+        cparse_log_set_error_code(error, cParseErrorMissingObjectId);
         return false;
     }
 
@@ -415,7 +577,7 @@ bool cparse_object_fetch(cParseObject *obj, cParseError **error)
     }
 
     if (!cparse_object_exists(obj)) {
-        cparse_log_set_error(error, "Object has no id");
+        cparse_log_set_error_code(error, cParseErrorMissingObjectId);
         return false;
     }
 
@@ -432,9 +594,7 @@ bool cparse_object_fetch(cParseObject *obj, cParseError **error)
     cparse_request_free(request);
 
     if (json) {
-        cparse_object_merge_json(obj, json);
-
-        cparse_json_free(json);
+        cparse_object_adopt_json(obj, json);
 
         return true;
     }
@@ -453,6 +613,300 @@ bool cparse_object_fetch_in_background(cParseObject *obj, cParseObjectCallback c
     return cparse_object_run_in_background(obj, cparse_object_fetch, callback, param, NULL);
 }
 
+/* for fetching pointers in the background */
+typedef struct {
+    cParseObject **objects;
+    size_t count;
+    cParseObjectListCallback callback;
+    void *param;
+} cParseObjectListThread;
+
+/* collects the distinct pointer ids in a set of objects as { className: { objectId: true } } */
+static cParseJson *cparse_object_collect_pointers(cParseObject **objects, size_t count)
+{
+    cParseJson *classes = cparse_json_new();
+    size_t i;
+
+    if (classes == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (objects[i] == NULL) {
+            continue;
+        }
+
+        cparse_object_materialize(objects[i]);
+
+        cparse_json_foreach_start(objects[i]->attributes, key, val)
+        {
+            const char *className = NULL;
+            const char *objectId = NULL;
+            cParseJson *ids = NULL;
+
+            if (!cparse_json_is_pointer(val)) {
+                continue;
+            }
+
+            className = cparse_json_get_string(val, CPARSE_KEY_CLASS_NAME);
+            objectId = cparse_json_get_string(val, CPARSE_KEY_OBJECT_ID);
+
+            if (cparse_str_empty(className) || cparse_str_empty(objectId)) {
+                continue;
+            }
+
+            ids = cparse_json_get(classes, className);
+
+            if (ids == NULL) {
+                ids = cparse_json_new();
+                cparse_json_set(classes, className, ids);
+            }
+
+            /* the object keys are the set */
+            cparse_json_set_bool(ids, objectId, true);
+        }
+        cparse_json_foreach_end;
+    }
+
+    return classes;
+}
+
+/* creates a query for a class, taking care of the special classes */
+static cParseQuery *cparse_object_query_for_class(const char *className)
+{
+    cParseQuery *query = cparse_query_with_class_name(className);
+
+    if (query == NULL) {
+        return NULL;
+    }
+
+    if (!strcmp(className, CPARSE_CLASS_USER)) {
+        cparse_replace_str(&query->urlPath, CPARSE_USERS_PATH);
+    } else if (!strcmp(className, CPARSE_CLASS_ROLE)) {
+        cparse_replace_str(&query->urlPath, CPARSE_ROLES_PATH);
+    }
+
+    return query;
+}
+
+/* runs one query for an array of ids and adds the results to fetched, keyed by id */
+static bool cparse_object_fetch_ids(const char *className, cParseJson *inArray, cParseJson *fetched, cParseError **error)
+{
+    cParseQuery *query = cparse_object_query_for_class(className);
+    size_t i;
+
+    if (query == NULL) {
+        cparse_json_free(inArray);
+        cparse_log_set_error(error, "unable to create query");
+        return false;
+    }
+
+    query->limit = CPARSE_QUERY_MAX_LIMIT;
+
+    /* only the raw results are needed */
+    query->lazy = true;
+
+    cparse_query_where_in(query, CPARSE_KEY_OBJECT_ID, inArray);
+
+    if (!cparse_query_find_objects(query, error)) {
+        cparse_query_free(query);
+        return false;
+    }
+
+    for (i = 0; i < query->size; i++) {
+        cParseJson *row = cparse_json_array_get(query->response, i);
+        const char *objectId = cparse_json_get_string(row, CPARSE_KEY_OBJECT_ID);
+
+        if (cparse_str_empty(objectId)) {
+            continue;
+        }
+
+        /* the same form as an included pointer */
+        cparse_json_set_string(row, CPARSE_KEY_TYPE, CPARSE_TYPE_OBJECT);
+        cparse_json_set_string(row, CPARSE_KEY_CLASS_NAME, className);
+
+        cparse_json_set(fetched, objectId, cparse_json_new_reference(row));
+    }
+
+    cparse_query_free(query);
+
+    return true;
+}
+
+/* queries a set of ids for a class in chunks the server will accept */
+static bool cparse_object_fetch_class(const char *className, cParseJson *ids, cParseJson *fetched, cParseError **error)
+{
+    cParseJson *inArray = NULL;
+
+    cparse_json_foreach_start(ids, objectId, unused)
+    {
+        if (inArray == NULL) {
+            inArray = cparse_json_new_array();
+        }
+
+        cparse_json_array_add_string(inArray, objectId);
+
+        if (cparse_json_array_size(inArray) == CPARSE_QUERY_MAX_LIMIT) {
+            if (!cparse_object_fetch_ids(className, inArray, fetched, error)) {
+                return false;
+            }
+            inArray = NULL;
+        }
+    }
+    cparse_json_foreach_end;
+
+    if (inArray != NULL) {
+        return cparse_object_fetch_ids(className, inArray, fetched, error);
+    }
+
+    return true;
+}
+
+bool cparse_object_fetch_pointers(cParseObject **objects, size_t count, cParseError **error)
+{
+    cParseJson *classes = NULL;
+    cParseJson *results = NULL;
+    cParseJson *fetched = NULL;
+    cParseJson *replaced = NULL;
+    size_t i;
+
+    if (objects == NULL) {
+        cparse_log_set_errno(error, EINVAL);
+        return false;
+    }
+
+    classes = cparse_object_collect_pointers(objects, count);
+
+    if (classes == NULL) {
+        cparse_log_set_errno(error, ENOMEM);
+        return false;
+    }
+
+    /* the fetched objects keyed by class, as the classes can't change while iterated */
+    results = cparse_json_new();
+
+    /* one query per class instead of one fetch per pointer */
+    cparse_json_foreach_start(classes, className, ids)
+    {
+        fetched = cparse_json_new();
+
+        if (!cparse_object_fetch_class(className, ids, fetched, error)) {
+            cparse_json_free(fetched);
+            cparse_json_free(results);
+            cparse_json_free(classes);
+            return false;
+        }
+
+        cparse_json_set(results, className, fetched);
+    }
+    cparse_json_foreach_end;
+
+    cparse_json_free(classes);
+
+    for (i = 0; i < count; i++) {
+        if (objects[i] == NULL) {
+            continue;
+        }
+
+        /* the replacements are applied after iterating the attributes */
+        replaced = cparse_json_new();
+
+        cparse_json_foreach_start(objects[i]->attributes, key, val)
+        {
+            cParseJson *target = NULL;
+
+            if (!cparse_json_is_pointer(val)) {
+                continue;
+            }
+
+            fetched = cparse_json_get(results, cparse_json_get_string(val, CPARSE_KEY_CLASS_NAME));
+
+            target = cparse_json_get(fetched, cparse_json_get_string(val, CPARSE_KEY_OBJECT_ID));
+
+            /* targets are shared between objects */
+            if (target != NULL) {
+                cparse_json_set(replaced, key, cparse_json_new_reference(target));
+            }
+        }
+        cparse_json_foreach_end;
+
+        cparse_json_copy(objects[i]->attributes, replaced, true);
+
+        cparse_json_free(replaced);
+    }
+
+    cparse_json_free(results);
+
+    return true;
+}
+
+static void *cparse_object_fetch_pointers_action(void *argument)
+{
+    cParseObjectListThread *arg = (cParseObjectListThread *)argument;
+    cParseError *error = NULL;
+
+    cparse_object_fetch_pointers(arg->objects, arg->count, &error);
+
+    if (arg->callback) {
+        (*arg->callback)(arg->objects, arg->count, error, arg->param);
+    }
+
+    if (error) {
+        cparse_log_warn(cparse_error_message(error));
+
+        /* callbacks should never have to free the error parameter */
+        cparse_error_free(error);
+    }
+
+    cparse_free(arg);
+
+    pthread_mutex_lock(&cparse_thread_count_mutex);
+    cparse_thread_count--;
+    pthread_mutex_unlock(&cparse_thread_count_mutex);
+
+    return NULL;
+}
+
+bool cparse_object_fetch_pointers_in_background(cParseObject **objects, size_t count, cParseObjectListCallback callback,
+                                                void *param)
+{
+    cParseObjectListThread *arg = NULL;
+    pthread_t thread;
+
+    if (objects == NULL) {
+        cparse_log_errno(EINVAL);
+        return false;
+    }
+
+    arg = cparse_malloc(sizeof(cParseObjectListThread));
+
+    if (arg == NULL) {
+        cparse_log_errno(ENOMEM);
+        return false;
+    }
+
+    arg->objects = objects;
+    arg->count = count;
+    arg->callback = callback;
+    arg->param = param;
+
+    if (pthread_create(&thread, NULL, cparse_object_fetch_pointers_action, arg)) {
+        cparse_log_error("unable to create background thread (%s)", strerror(errno));
+        cparse_free(arg);
+        return false;
+    }
+
+    pthread_mutex_lock(&cparse_thread_count_mutex);
+    cparse_thread_count++;
+    pthread_mutex_unlock(&cparse_thread_count_mutex);
+
+    if (pthread_detach(thread)) {
+        cparse_log_errno(errno);
+    }
+
+    return true;
+}
+
 bool cparse_object_refresh(cParseObject *obj, cParseError **error)
 {
     cParseRequest *request = NULL;
@@ -463,8 +917,10 @@ bool cparse_object_refresh(cParseObject *obj, cParseError **error)
         return false;
     }
 
+    cparse_object_materialize(obj);
+
     if (cparse_str_empty(obj->objectId)) {
-        cparse_log_set_error(error, "Object has no id");
+        cparse_log_set_error_code(error, cParseErrorMissingObjectId);
         return false;
     }
 
@@ -479,9 +935,7 @@ bool cparse_object_refresh(cParseObject *obj, cParseError **error)
     cparse_request_free(request);
 
     if (json) {
-        cparse_object_merge_json(obj, json);
-
-        cparse_json_free(json);
+        cparse_object_adopt_json(obj, json);
 
         return true;
     }
@@ -518,6 +972,8 @@ bool cparse_object_save(cParseObject *obj, cParseError **error)
         return false;
     }
 
+    cparse_object_materialize(obj);
+
     /* build the request based on the id */
     if (cparse_str_empty(obj->objectId)) {
         request = cparse_request_with_method_and_path(cParseHttpRequestMethodPost, obj->urlPath);
@@ -539,9 +995,7 @@ bool cparse_object_save(cParseObject *obj, cParseError **error)
     cparse_request_free(request);
 
     if (json != NULL) {
-        cparse_object_merge_json(obj, json);
-
-        cparse_json_free(json);
+        cparse_object_adopt_json(obj, json);
 
         return true;
     }
@@ -571,9 +1025,11 @@ bool cparse_object_update(cParseObject *obj, cParseJson *attributes, cParseError
         return false;
     }
 
+    cparse_object_materialize(obj);
+
     /* build the request based on the id */
     if (cparse_str_empty(obj->objectId)) {
-        cparse_log_set_error(error, "object has no id");
+        cparse_log_set_error_code(error, cParseErrorMissingObjectId);
         return false;
     }
 
@@ -595,9 +1051,7 @@ bool cparse_object_update(cParseObject *obj, cParseJson *attributes, cParseError
     if (response != NULL) {
         cparse_object_merge_json(obj, attributes);
 
-        cparse_object_merge_json(obj, response);
-
-        cparse_json_free(response);
+        cparse_object_adopt_json(obj, response);
 
         return true;
     }
@@ -643,6 +1097,8 @@ bool cparse_object_update_in_background(cParseObject *obj, cParseJson *json, cPa
 
 void cparse_object_set_number(cParseObject *obj, const char *key, cParseNumber value)
 {
+    cparse_object_materialize(obj);
+
     if (obj != NULL && obj->attributes) {
         cparse_json_set_number(obj->attributes, key, value);
     } else {
@@ -652,6 +1108,8 @@ void cparse_object_set_number(cParseObject *obj, const char *key, cParseNumber v
 
 void cparse_object_set_real(cParseObject *obj, const char *key, double value)
 {
+    cparse_object_materialize(obj);
+
     if (obj != NULL && obj->attributes) {
         cparse_json_set_real(obj->attributes, key, value);
     } else {
@@ -660,6 +1118,8 @@ void cparse_object_set_real(cParseObject *obj, const char *key, double value)
 }
 void cparse_object_set_bool(cParseObject *obj, const char *key, bool value)
 {
+    cparse_object_materialize(obj);
+
     if (obj != NULL && obj->attributes) {
         cparse_json_set_bool(obj->attributes, key, value);
     } else {
@@ -669,6 +1129,8 @@ void cparse_object_set_bool(cParseObject *obj, const char *key, bool value)
 
 void cparse_object_set_string(cParseObject *obj, const char *key, const char *value)
 {
+    cparse_object_materialize(obj);
+
     if (obj != NULL && obj->attributes) {
         cparse_json_set_string(obj->attributes, key, value);
     } else {
@@ -678,6 +1140,8 @@ void cparse_object_set_string(cParseObject *obj, const char *key, const char *va
 
 void cparse_object_set(cParseObject *obj, const char *key, cParseJson *value)
 {
+    cparse_object_materialize(obj);
+
     if (obj != NULL && obj->attributes) {
         cparse_json_set(obj->attributes, key, value);
     } else {
@@ -693,6 +1157,8 @@ void cparse_object_foreach_attribute(cParseObject *obj, cParseObjectAttributeCal
         return;
     }
 
+    cparse_object_materialize(obj);
+
     cparse_json_foreach_start(obj->attributes, key, val)
     {
         callback(obj, key, val, param);
@@ -702,6 +1168,8 @@ void cparse_object_foreach_attribute(cParseObject *obj, cParseObjectAttributeCal
 
 cParseJson *cparse_object_remove_and_get(cParseObject *obj, const char *key)
 {
+    cparse_object_materialize(obj);
+
     return cparse_json_remove_and_get(obj->attributes, key);
 }
 
@@ -711,44 +1179,51 @@ void cparse_object_remove(cParseObject *obj, const char *key)
         cparse_log_errno(EINVAL);
         return;
     }
+
+    cparse_object_materialize(obj);
+
     cparse_json_remove(obj->attributes, key);
 }
 
 /* getters */
 
+/* the getters read a lazy result without merging it, as if it had been */
+
 cParseJson *cparse_object_get(cParseObject *obj, const char *key)
 {
-    return !obj ? NULL : cparse_json_get(obj->attributes, key);
+    return !obj || cparse_object_is_hidden_key(obj, key) ? NULL : cparse_json_get(obj->attributes, key);
 }
 
 cParseNumber cparse_object_get_number(cParseObject *obj, const char *key, cParseNumber def)
 {
-    return !obj ? def : cparse_json_get_number(obj->attributes, key, def);
+    return !obj || cparse_object_is_hidden_key(obj, key) ? def : cparse_json_get_number(obj->attributes, key, def);
 }
 
 double cparse_object_get_real(cParseObject *obj, const char *key, double def)
 {
-    return !obj ? def : cparse_json_get_real(obj->attributes, key, def);
+    return !obj || cparse_object_is_hidden_key(obj, key) ? def : cparse_json_get_real(obj->attributes, key, def);
 }
 
 bool cparse_object_get_bool(cParseObject *obj, const char *key)
 {
-    return !obj ? false : cparse_json_get_bool(obj->attributes, key);
+    return !obj || cparse_object_is_hidden_key(obj, key) ? false : cparse_json_get_bool(obj->attributes, key);
 }
 
 const char *cparse_object_get_string(cParseObject *obj, const char *key)
 {
-    return !obj ? NULL : cparse_json_get_string(obj->attributes, key);
+    return !obj || cparse_object_is_hidden_key(obj, key) ? NULL : cparse_json_get_string(obj->attributes, key);
 }
 
 size_t cparse_object_attribute_size(cParseObject *obj)
 {
+    cparse_object_materialize(obj);
+
     return !obj ? 0 : cparse_json_num_keys(obj->attributes);
 }
 
 bool cparse_object_contains(cParseObject *obj, const char *key)
 {
-    return !obj ? false : cparse_json_contains(obj->attributes, key);
+    return !obj || cparse_object_is_hidden_key(obj, key) ? false : cparse_json_contains(obj->attributes, key);
 }
 
 void cparse_object_set_reference(cParseObject *obj, const char *key, cParseObject *ref)
@@ -760,6 +1235,8 @@ void cparse_object_set_reference(cParseObject *obj, const char *key, cParseObjec
         return;
     }
 
+    cparse_object_materialize(obj);
+
     /* create a data object representing a pointer */
     data = cparse_pointer_from_object(ref);
 
@@ -769,51 +1246,25 @@ void cparse_object_set_reference(cParseObject *obj, const char *key, cParseObjec
 
 void cparse_object_merge_json(cParseObject *a, cParseJson *b)
 {
-    /* objectId, createdAt, and updatedAt are special attributes
-     * we're remove them from the b if they exist and add them to a
-     */
-    cParseJson *id = NULL;
-
     if (!a || !b) {
         cparse_log_errno(EINVAL);
         return;
     }
 
-    id = cparse_json_remove_and_get(b, CPARSE_KEY_OBJECT_ID);
-
-    if (id != NULL) {
-        cparse_replace_str(&a->objectId, cparse_json_to_string(id));
-
-        cparse_json_free(id);
-    }
-
-    id = cparse_json_remove_and_get(b, CPARSE_KEY_CREATED_AT);
-
-    if (id != NULL) {
-        a->createdAt = cparse_date_time(cparse_json_to_string(id));
-
-        cparse_json_free(id);
-    }
-
-    id = cparse_json_remove_and_get(b, CPARSE_KEY_UPDATED_AT);
-
-    if (id != NULL) {
-        a->updatedAt = cparse_date_time(cparse_json_to_string(id));
-
-        cparse_json_free(id);
-    }
-
-    id = cparse_json_remove_and_get(b, CPARSE_KEY_CLASS_NAME);
+    cparse_object_materialize(a);
 
-    if (id != NULL) {
-        cparse_json_free(id);
-    }
+    /* objectId, createdAt, and updatedAt are special attributes
+     * we're remove them from the b if they exist and add them to a
+     */
+    cparse_object_take_keys(a, b);
 
     cparse_json_copy(a->attributes, b, true);
 }
 
 const char *cparse_object_to_json_string(cParseObject *obj)
 {
+    cparse_object_materialize(obj);
+
     return !obj ? NULL : cparse_json_to_json_string(obj->attributes);
 }
 
@@ -827,6 +1278,8 @@ static void cparse_object_add_acl(cParseObject *obj, const char *key, cParseAcce
         return;
     }
 
+    cparse_object_materialize(obj);
+
     acl = cparse_json_get(obj->attributes, CPARSE_KEY_ACL);
 
     if (acl == NULL) {
@@ -864,6 +1317,8 @@ void cparse_object_set_public_acl(cParseObject *obj, cParseAccess access, bool v
 
 void cparse_object_set_user_acl(cParseObject *obj, cParseUser *user, cParseAccess access, bool value)
 {
+    cparse_object_materialize(user);
+
     if (!obj || !user || !cparse_object_is_user(user) || cparse_str_empty(user->objectId)) {
         cparse_log_errno(EINVAL);
         return;
@@ -5,8 +5,11 @@
 #include <time.h>
 #include <string.h>
 #include <cparse/parse.h>
+#include <cparse/memory.h>
 #include "protocol.h"
 #include "client.h"
+#include "request.h"
+#include "log.h"
 
 const char *const cparse_lib_version = "1.0";
 
@@ -14,21 +17,36 @@ const char *cparse_app_id = NULL;
 
 const char *cparse_api_key = NULL;
 
+const char *cparse_server_url = NULL;
+
 extern cParseLogLevel cparse_current_log_level;
 
 bool cparse_revocable_sessions = false;
 
+cParseTraceHooks cparse_trace_hooks = {NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+
+const char *cparse_correlation_header = NULL;
+
+int cparse_request_retries = 0;
+
 const char *const CPARSE_RESERVED_KEYS[] = {CPARSE_KEY_CLASS_NAME, CPARSE_KEY_CREATED_AT, CPARSE_KEY_OBJECT_ID, CPARSE_KEY_UPDATED_AT,
                                             CPARSE_KEY_USER_SESSION_TOKEN};
 
 void cparse_set_application_id(const char *appId)
 {
-    cparse_app_id = strdup(appId);
+    cparse_app_id = cparse_strdup(appId);
 }
 
 void cparse_set_api_key(const char *apiKey)
 {
-    cparse_api_key = strdup(apiKey);
+    cparse_api_key = cparse_strdup(apiKey);
+}
+
+void cparse_set_server_url(const char *url)
+{
+    cparse_free((char *)cparse_server_url);
+
+    cparse_server_url = url ? cparse_strdup(url) : NULL;
 }
 
 void cparse_set_log_level(cParseLogLevel value)
@@ -41,10 +59,42 @@ void cparse_enable_revocable_sessions(bool value)
     cparse_revocable_sessions = value;
 }
 
+void cparse_set_trace_hooks(const cParseTraceHooks *hooks)
+{
+    if (hooks == NULL) {
+        memset(&cparse_trace_hooks, 0, sizeof(cparse_trace_hooks));
+    } else {
+        cparse_trace_hooks = *hooks;
+    }
+}
+
+void cparse_set_correlation_header(const char *name)
+{
+    cparse_free((char *)cparse_correlation_header);
+
+    cparse_correlation_header = name ? cparse_strdup(name) : NULL;
+}
+
+void cparse_set_request_retries(int count)
+{
+    cparse_request_retries = count > 0 ? count : 0;
+}
+
 void cparse_global_cleanup()
 {
     cparse_free_client();
 
-    free((char *)cparse_app_id);
-    free((char *)cparse_api_key);
+    cparse_request_pool_cleanup();
+
+    cparse_log_cleanup();
+
+    cparse_free((char *)cparse_app_id);
+    cparse_free((char *)cparse_api_key);
+    cparse_free((char *)cparse_correlation_header);
+    cparse_free((char *)cparse_server_url);
+
+    cparse_app_id = NULL;
+    cparse_api_key = NULL;
+    cparse_correlation_header = NULL;
+    cparse_server_url = NULL;
 }
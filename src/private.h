@@ -23,12 +23,20 @@ struct cparse_object {
     char *objectId;
     time_t updatedAt;
     time_t createdAt;
+    /* response values the id and dates are read from without copying */
+    cParseJson *objectIdRef;
+    cParseJson *createdAtRef;
+    cParseJson *updatedAtRef;
+    /* a query result view that has not been merged yet */
+    bool lazy;
 };
 
 
 struct cparse_query {
     cParseJson *where;
     cParseObject **results;
+    /* the raw results kept for lazy objects */
+    cParseJson *response;
     char *className;
     char *urlPath;
     char *keys;
@@ -37,6 +45,7 @@ struct cparse_query {
     int skip;
     bool trace;
     bool count;
+    bool lazy;
 };
 
 struct cparse_query_builder {
@@ -103,6 +112,13 @@ BEGIN_DECL
 bool cparse_object_run_in_background(cParseObject *obj, cParseObjectAction action, cParseObjectCallback callback, void *param,
                                      void (*cleanup)(cParseObject *));
 
+/* converts a lazy query result into a full object */
+void cparse_object_materialize(cParseObject *obj);
+
+/* merges a response into an object, taking ownership of the json.
+ * the json becomes the object attributes when the object has none. */
+void cparse_object_adopt_json(cParseObject *obj, cParseJson *json);
+
 END_DECL
 
 #endif
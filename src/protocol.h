@@ -49,6 +49,8 @@
 
 #define CPARSE_KEY_TYPE "__type"
 
+#define CPARSE_KEY_BASE64 "base64"
+
 #define CPARSE_KEY_AMOUNT "amount"
 
 #define CPARSE_KEY_EMAIL_VERIFIED "emailVerified"
@@ -93,6 +95,9 @@ extern const char *const CPARSE_RESERVED_KEYS[];
 
 #define CPARSE_BATCH_REQUEST_URI "batch"
 
+/* the most results a query can return */
+#define CPARSE_QUERY_MAX_LIMIT 1000
+
 #define CPARSE_ACL_PUBLIC "*"
 
 #define CPARSE_ERROR_INTERNAL 1
@@ -5,6 +5,7 @@
 #include <cparse/util.h>
 #include <cparse/json.h>
 #include <cparse/types.h>
+#include <cparse/memory.h>
 #include <errno.h>
 #include "client.h"
 #include "request.h"
@@ -44,7 +45,7 @@ void cparse_query_clear_all_caches()
 
 cParseQuery *cparse_query_new()
 {
-    cParseQuery *query = malloc(sizeof(cParseQuery));
+    cParseQuery *query = cparse_malloc(sizeof(cParseQuery));
 
     if (query == NULL) {
         cparse_log_errno(ENOMEM);
@@ -58,8 +59,10 @@ cParseQuery *cparse_query_new()
     query->trace = false;
     query->where = NULL;
     query->results = NULL;
+    query->response = NULL;
     query->keys = NULL;
     query->count = false;
+    query->lazy = false;
     query->size = 0;
 
     return query;
@@ -71,34 +74,28 @@ void cparse_query_free(cParseQuery *query)
         return;
     }
     if (query->className) {
-        free(query->className);
+        cparse_free(query->className);
     }
 
     if (query->urlPath) {
-        free(query->urlPath);
+        cparse_free(query->urlPath);
     }
 
     if (query->keys) {
-        free(query->keys);
+        cparse_free(query->keys);
     }
 
     if (query->results) {
-        size_t i = 0;
+        cparse_query_free_results(query);
 
-        for (; i < query->size; i++) {
-            /* may have been freed already */
-            if (query->results[i]) {
-                cparse_object_free(query->results[i]);
-            }
-        }
-        free(query->results);
+        cparse_free(query->results);
     }
 
     if (query->where) {
         cparse_json_free(query->where);
     }
 
-    free(query);
+    cparse_free(query);
 }
 
 void cparse_query_free_results(cParseQuery *query)
@@ -109,13 +106,19 @@ void cparse_query_free_results(cParseQuery *query)
         return;
     }
 
-    for (i = 0; i < query->size; i++) {
+    for (i = 0; query->results && i < query->size; i++) {
+        /* may have been freed already */
         if (query->results[i]) {
             cparse_object_free(query->results[i]);
         }
         query->results[i] = NULL;
     }
 
+    if (query->response) {
+        cparse_json_free(query->response);
+        query->response = NULL;
+    }
+
     query->size = 0;
 }
 
@@ -135,11 +138,11 @@ cParseQuery *cparse_query_with_class_name(const char *className)
         return NULL;
     }
 
-    query->className = strdup(className);
+    query->className = cparse_strdup(className);
 
     snprintf(buf, CPARSE_BUF_SIZE, "%s%s", CPARSE_OBJECTS_PATH, className);
 
-    query->urlPath = strdup(buf);
+    query->urlPath = cparse_strdup(buf);
 
     return query;
 }
@@ -159,8 +162,8 @@ cParseQuery *cparse_query_for_object(cParseObject *obj)
         return NULL;
     }
 
-    query->className = strdup(obj->className);
-    query->urlPath = strdup(obj->urlPath);
+    query->className = cparse_strdup(obj->className);
+    query->urlPath = cparse_strdup(obj->urlPath);
 
     return query;
 }
@@ -172,12 +175,27 @@ size_t cparse_query_size(cParseQuery *query)
     return query ? query->size : 0;
 }
 
+void cparse_query_set_lazy_results(cParseQuery *query, bool value)
+{
+    if (query == NULL) {
+        cparse_log_errno(EINVAL);
+        return;
+    }
+
+    query->lazy = value;
+}
+
 cParseObject *cparse_query_result(cParseQuery *query, size_t index)
 {
-    if (!query || !query->results || index > query->size) {
+    if (!query || !query->results || index >= query->size) {
         return NULL;
     }
 
+    /* lazy results are created on first access */
+    if (query->results[index] == NULL && query->response != NULL) {
+        query->results[index] = cparse_object_from_query(query, cparse_json_array_get(query->response, index));
+    }
+
     return query->results[index];
 }
 
@@ -233,23 +251,24 @@ bool cparse_query_find_objects(cParseQuery *query, cParseError **error)
         return false;
     }
 
+    if (query->results) {
+        cparse_query_free_results(query);
+
+        cparse_free(query->results);
+
+        query->results = NULL;
+    }
+
     if (query->count) {
         query->size = cparse_json_get_number(data, CPARSE_QUERY_COUNT, 0);
     } else {
         cParseJson *results = cparse_json_get(data, CPARSE_QUERY_RESULTS);
+        size_t size = cparse_json_array_size(results);
 
-        query->size = cparse_json_array_size(results);
-
-        if (query->size > 0) {
-            int i;
-
-            if (query->results) {
-                cparse_query_free_results(query);
+        if (size > 0) {
+            size_t i;
 
-                free(query->results);
-            }
-
-            query->results = malloc(cparse_object_sizeof() * query->size);
+            query->results = cparse_calloc(size, sizeof(cParseObject *));
 
             if (query->results == NULL) {
                 cparse_log_set_errno(error, ENOMEM);
@@ -257,8 +276,15 @@ bool cparse_query_find_objects(cParseQuery *query, cParseError **error)
                 return false;
             }
 
-            for (i = 0; i < query->size; i++) {
-                query->results[i] = cparse_object_from_query(query, cparse_json_array_get(results, i));
+            query->size = size;
+
+            if (query->lazy) {
+                /* objects are created by cparse_query_result() */
+                query->response = cparse_json_new_reference(results);
+            } else {
+                for (i = 0; i < size; i++) {
+                    query->results[i] = cparse_object_from_query(query, cparse_json_array_get(results, i));
+                }
             }
         }
     }
@@ -560,7 +586,7 @@ void cparse_query_where_all(cParseQuery *query, const char *key, cParseJson *val
 
 cParseQueryBuilder *cparse_query_build_new()
 {
-    cParseQueryBuilder *builder = malloc(sizeof(cParseQueryBuilder));
+    cParseQueryBuilder *builder = cparse_malloc(sizeof(cParseQueryBuilder));
 
     if (builder == NULL) {
         cparse_log_errno(ENOMEM);
@@ -825,7 +851,7 @@ void cparse_query_build_free(cParseQueryBuilder *query)
         cparse_json_free(query->json);
     }
 
-    free(query);
+    cparse_free(query);
 }
 
 cParseQueryBuilder *cparse_query_build_related_to(cParseQueryBuilder *query, const char *key, cParseObject *obj)
@@ -8,11 +8,13 @@
 #include <errno.h>
 #include <curl/curl.h>
 #include <stdarg.h>
+#include <pthread.h>
 #include <json.h>
 #include <cparse/json.h>
 #include <cparse/object.h>
 #include <cparse/error.h>
 #include <cparse/util.h>
+#include <cparse/memory.h>
 #include "request.h"
 #include "protocol.h"
 #include "private.h"
@@ -21,25 +23,180 @@
 
 cParseResponse *cparse_client_execute(cParseRequest *request);
 
-/*! allocates a new client request
- * \param method the http method to use
- * \param path the path/endpoint to request
- */
-cParseRequest *cparse_request_with_method_and_path(cParseHttpRequestMethod method, const char *path)
+/* buffers larger than this are not kept by a reused request */
+#define CPARSE_REQUEST_RETAIN_SIZE (64 * 1024)
+
+static pthread_key_t cparse_request_pool_key;
+
+static pthread_once_t cparse_request_pool_once = PTHREAD_ONCE_INIT;
+
+static void cparse_request_destroy(cParseRequest *request)
+{
+    if (request->path) {
+        cparse_free(request->path);
+    }
+    if (request->body) {
+        cparse_free(request->body);
+    }
+    if (request->response.text) {
+        cparse_free(request->response.text);
+    }
+
+    cparse_dlist_destroy(&request->headers);
+    cparse_dlist_destroy(&request->data);
+
+    cparse_free(request);
+}
+
+/* frees a thread's request when the thread exits */
+static void cparse_request_pool_destructor(void *value)
+{
+    if (value != NULL) {
+        cparse_request_destroy((cParseRequest *)value);
+    }
+}
+
+static void cparse_request_pool_init()
+{
+    if (pthread_key_create(&cparse_request_pool_key, cparse_request_pool_destructor)) {
+        cparse_log_errno(errno);
+    }
+}
+
+/* grows a buffer to hold at least size bytes */
+static bool cparse_request_reserve(char **buf, size_t *capacity, size_t size)
+{
+    size_t newCapacity = *capacity ? *capacity : 128;
+    char *newBuf = NULL;
+
+    if (*buf != NULL && size <= *capacity) {
+        return true;
+    }
+
+    while (newCapacity < size) {
+        newCapacity *= 2;
+    }
+
+    newBuf = cparse_realloc(*buf, newCapacity);
+
+    if (newBuf == NULL) {
+        cparse_log_errno(ENOMEM);
+        return false;
+    }
+
+    *buf = newBuf;
+    *capacity = newCapacity;
+
+    return true;
+}
+
+/* drops a buffer that grew too large to keep around */
+static void cparse_request_trim(char **buf, size_t *capacity)
+{
+    if (*capacity > CPARSE_REQUEST_RETAIN_SIZE) {
+        cparse_free(*buf);
+        *buf = NULL;
+        *capacity = 0;
+    }
+}
+
+static cParseRequest *cparse_request_new()
 {
-    cParseRequest *request = malloc(sizeof(cParseRequest));
+    cParseRequest *request = cparse_malloc(sizeof(cParseRequest));
 
     if (request == NULL) {
         cparse_log_errno(ENOMEM);
         return NULL;
     }
 
-    request->path = strdup(path);
+    request->id = 0;
+    request->path = NULL;
+    request->pathCapacity = 0;
     request->body = NULL;
     request->bodySize = 0;
-    request->data = NULL;
+    request->bodyCapacity = 0;
+    request->method = cParseHttpRequestMethodGet;
+    request->response.text = NULL;
+    request->response.size = 0;
+    request->response.capacity = 0;
+    request->response.code = 0;
+    request->pooled = false;
+    request->inUse = false;
+    request->enqueued = 0;
+    request->attempt = 0;
+    request->receiving = false;
+    request->correlationId[0] = 0;
+    cparse_dlist_init(&request->data);
+    cparse_dlist_init(&request->headers);
+
+    return request;
+}
+
+bool cparse_request_reset(cParseRequest *request, cParseHttpRequestMethod method, const char *path)
+{
+    size_t size = 0;
+
+    if (request == NULL || path == NULL) {
+        cparse_log_errno(EINVAL);
+        return false;
+    }
+
+    size = strlen(path) + 1;
+
+    if (!cparse_request_reserve(&request->path, &request->pathCapacity, size)) {
+        return false;
+    }
+
+    memcpy(request->path, path, size);
+
     request->method = method;
-    request->headers = NULL;
+
+    if (request->body) {
+        request->body[0] = 0;
+    }
+    request->bodySize = 0;
+
+    cparse_response_reset(&request->response);
+
+    cparse_dlist_clear(&request->data);
+    cparse_dlist_clear(&request->headers);
+
+    return true;
+}
+
+/*! allocates a new client request
+ * \param method the http method to use
+ * \param path the path/endpoint to request
+ */
+cParseRequest *cparse_request_with_method_and_path(cParseHttpRequestMethod method, const char *path)
+{
+    cParseRequest *request = NULL;
+
+    pthread_once(&cparse_request_pool_once, cparse_request_pool_init);
+
+    request = pthread_getspecific(cparse_request_pool_key);
+
+    /* use the thread's request unless a request is already in progress */
+    if (request == NULL || request->inUse) {
+        request = cparse_request_new();
+
+        if (request == NULL) {
+            return NULL;
+        }
+
+        if (pthread_getspecific(cparse_request_pool_key) == NULL && !pthread_setspecific(cparse_request_pool_key, request)) {
+            request->pooled = true;
+        }
+    }
+
+    if (!cparse_request_reset(request, method, path)) {
+        if (!request->pooled) {
+            cparse_request_destroy(request);
+        }
+        return NULL;
+    }
+
+    request->inUse = true;
 
     return request;
 }
@@ -47,134 +204,141 @@ cParseRequest *cparse_request_with_method_and_path(cParseHttpRequestMethod metho
 /*! deallocates a client request */
 void cparse_request_free(cParseRequest *request)
 {
-    cParseRequestHeader *header = NULL, *next_header = NULL;
-    cParseRequestData *data = NULL, *next_data = NULL;
-
     if (!request) {
         return;
     }
 
-    if (request->path) {
-        free(request->path);
+    if (!request->pooled) {
+        cparse_request_destroy(request);
+        return;
     }
+
+    /* keep the buffers for the next request on this thread */
+    request->inUse = false;
+
+    /* but not what was in them, ex. a login password */
+    cparse_dlist_wipe(&request->data);
+    cparse_dlist_wipe(&request->headers);
+
     if (request->body) {
-        free(request->body);
+        memset(request->body, 0, request->bodySize);
+    }
+    if (request->response.text) {
+        memset(request->response.text, 0, request->response.size);
     }
 
-    for (header = request->headers; header; header = next_header) {
-        next_header = header->next;
+    cparse_request_trim(&request->body, &request->bodyCapacity);
+    cparse_request_trim(&request->response.text, &request->response.capacity);
 
-        cparse_dlist_free(header);
-    }
+    request->bodySize = 0;
+    request->response.size = 0;
+}
+
+void cparse_request_pool_cleanup()
+{
+    cParseRequest *request = NULL;
+
+    pthread_once(&cparse_request_pool_once, cparse_request_pool_init);
 
-    for (data = request->data; data; data = next_data) {
-        next_data = data->next;
+    request = pthread_getspecific(cparse_request_pool_key);
 
-        cparse_dlist_free(data);
+    if (request != NULL && !request->inUse) {
+        pthread_setspecific(cparse_request_pool_key, NULL);
+
+        cparse_request_destroy(request);
     }
-    free(request);
 }
 
-cParseResponse *cparse_response_new()
+bool cparse_request_append_body(cParseRequest *request, const char *value, size_t size)
 {
-    cParseResponse *response = malloc(sizeof(cParseResponse));
+    if (!request || !value) {
+        cparse_log_errno(EINVAL);
+        return false;
+    }
 
-    if (response == NULL) {
-        cparse_log_errno(ENOMEM);
-        return NULL;
+    if (!cparse_request_reserve(&request->body, &request->bodyCapacity, request->bodySize + size + 1)) {
+        return false;
     }
 
-    response->text = NULL;
-    response->code = 0;
-    response->size = 0;
+    memcpy(request->body + request->bodySize, value, size);
+
+    request->bodySize += size;
+
+    request->body[request->bodySize] = 0;
 
-    return response;
+    return true;
 }
 
-/*! deallocates a response */
-void cparse_response_free(cParseResponse *response)
+void cparse_response_reset(cParseResponse *response)
 {
     if (!response) {
         return;
     }
 
-    if (response->size > 0 && response->text) {
-        free(response->text);
+    if (response->text) {
+        response->text[0] = 0;
     }
-
-    free(response);
+    response->size = 0;
+    response->code = 0;
 }
 
-void cparse_request_add_header(cParseRequest *request, const char *key, const char *value)
+bool cparse_response_append(cParseResponse *response, const char *text, size_t size)
 {
-    cParseRequestHeader *header = NULL;
-
-    if (!request || cparse_str_empty(key) || cparse_str_empty(value)) {
+    if (!response || !text) {
         cparse_log_errno(EINVAL);
-        return;
+        return false;
     }
 
-    header = cparse_dlist_new();
-
-    if (header == NULL) {
-        return;
+    if (!cparse_request_reserve(&response->text, &response->capacity, response->size + size + 1)) {
+        return false;
     }
 
-    header->next = request->headers;
-    request->headers = header;
+    memcpy(response->text + response->size, text, size);
+
+    response->size += size;
+
+    response->text[response->size] = 0;
 
-    header->key = strdup(key);
-    header->value = strdup(value);
+    return true;
 }
 
-void cparse_request_add_body(cParseRequest *request, const char *body)
+void cparse_request_add_header(cParseRequest *request, const char *key, const char *value)
 {
-    cParseRequestData *data = NULL;
-
-    if (request == NULL || cparse_str_empty(body)) {
+    if (!request || cparse_str_empty(key) || cparse_str_empty(value)) {
         cparse_log_errno(EINVAL);
         return;
     }
 
-    cparse_dlist_remove(&request->data, cparse_dlist_is_data);
-
-    data = cparse_dlist_new();
+    cparse_dlist_add(&request->headers, key, value);
+}
 
-    if (data == NULL) {
+void cparse_request_add_body(cParseRequest *request, const char *body)
+{
+    if (request == NULL || cparse_str_empty(body)) {
+        cparse_log_errno(EINVAL);
         return;
     }
 
-    data->next = request->data;
-    request->data = data;
+    /* the body replaces any data */
+    cparse_dlist_clear(&request->data);
 
     /* body has no key */
-    data->key = NULL;
-    data->value = strdup(body);
+    cparse_dlist_add(&request->data, NULL, body);
 }
 
 void cparse_request_add_data(cParseRequest *request, const char *key, const char *value)
 {
-    cParseRequestData *data = NULL;
-
     if (!request || cparse_str_empty(key) || cparse_str_empty(value)) {
         cparse_log_errno(EINVAL);
         return;
     }
 
     /* free the request body, as the two are synonymous */
-    cparse_dlist_remove(&request->data, cparse_dlist_is_value);
-
-    data = cparse_dlist_new();
-
-    if (data == NULL) {
-        return;
+    if (cparse_dlist_size(&request->data) == 1 && cparse_dlist_key(&request->data, 0) == NULL) {
+        cparse_dlist_clear(&request->data);
     }
 
-    data->key = strdup(key);
-    data->value = strdup(value);
-
-    data->next = request->data;
-    request->data = data;
+    cparse_dlist_add(&request->data, key, value);
 }
 
 bool cparse_request_execute(cParseRequest *request, cParseError **error)
@@ -188,13 +352,7 @@ bool cparse_request_execute(cParseRequest *request, cParseError **error)
 
     response = cparse_client_execute(request);
 
-    if (response != NULL) {
-        cparse_response_free(response);
-
-        return true;
-    }
-
-    return false;
+    return response != NULL;
 }
 
 cParseJson *cparse_response_parse_json(cParseResponse *response, cParseError **error)
@@ -205,9 +363,7 @@ cParseJson *cparse_response_parse_json(cParseResponse *response, cParseError **e
 
     const char *errorMessage = NULL;
 
-#ifdef HAVE_JSON_TOKENER_GET_ERROR
-    enum json_tokener_error parseError;
-#endif
+    int code = 0;
 
     if (response == NULL) {
         cparse_log_set_errno(error, EINVAL);
@@ -219,28 +375,28 @@ cParseJson *cparse_response_parse_json(cParseResponse *response, cParseError **e
     obj = json_tokener_parse_ex(tok, response->text, response->size);
 
 #ifdef HAVE_JSON_TOKENER_GET_ERROR
-    parseError = json_tokener_get_error(tok);
-
-    if (parseError != json_tokener_success) {
-        errorMessage = json_tokener_error_desc(parseError);
+    if (json_tokener_get_error(tok) != json_tokener_success) {
+        code = cParseErrorInvalidJson;
     }
 #else
     if (obj == NULL) {
-        errorMessage = "Unable to parse json";
+        code = cParseErrorInvalidJson;
     }
 #endif
 
+    json_tokener_free(tok);
+
     if (cparse_json_contains(obj, "error")) {
+        /* the server message is only copied if it isn't the known one for its code */
         errorMessage = cparse_json_get_string(obj, "error");
+        code = cparse_json_get_number(obj, "code", 0);
+    } else if (response->code >= 400) {
+        code = response->code;
     }
 
-    json_tokener_free(tok);
-
-    if (errorMessage != NULL) {
+    if (code != 0 || errorMessage != NULL) {
         if (error) {
-            *error = cparse_error_with_message(errorMessage);
-
-            cparse_error_set_code(*error, cparse_json_get_number(obj, "code", 0));
+            *error = errorMessage ? cparse_error_with_code_and_message(code, errorMessage) : cparse_error_with_code(code);
         }
 
         if (obj) {
@@ -265,14 +421,10 @@ cParseJson *cparse_request_get_json(cParseRequest *request, cParseError **error)
     response = cparse_client_execute(request);
 
     if (response != NULL) {
-        cParseJson *json = cparse_response_parse_json(response, error);
-
-        cparse_response_free(response);
-
-        return json;
+        return cparse_response_parse_json(response, error);
     }
 
-    cparse_log_set_error(error, "Unable to get response to request");
+    cparse_log_set_error_code(error, cParseErrorConnectionFailed);
 
     return NULL;
 }
@@ -3,6 +3,7 @@
 
 #include <cparse/defines.h>
 #include "private.h"
+#include "data_list.h"
 
 /*! HTTP Request Method Types */
 typedef enum {
@@ -12,33 +13,60 @@ typedef enum {
     cParseHttpRequestMethodDelete
 } cParseHttpRequestMethod;
 
-/*! a parse request */
-struct cparse_request {
-    char *path;
-    cParseRequestData *data;
-    char *body;
-    size_t bodySize;
-    cParseHttpRequestMethod method;
-    cParseRequestHeader *headers;
-};
+/*! the longest correlation id sent with a request */
+#define CPARSE_CORRELATION_ID_SIZE 128
 
 /*! a parse response */
 struct cparse_client_response {
     char *text;
     size_t size;
+    size_t capacity;
     int code;
 };
 
+/*! a parse request */
+struct cparse_request {
+    /* a unique id assigned when the request is executed */
+    unsigned long id;
+    char *path;
+    size_t pathCapacity;
+    cParseRequestData data;
+    char *body;
+    size_t bodySize;
+    size_t bodyCapacity;
+    cParseHttpRequestMethod method;
+    cParseRequestHeader headers;
+    /* kept with the request so the buffer is reused */
+    cParseResponse response;
+    /* the calling thread's reusable request */
+    bool pooled;
+    bool inUse;
+    /* for tracing: when the request was enqueued, the current attempt and the correlation header value */
+    double enqueued;
+    int attempt;
+    bool receiving;
+    char correlationId[CPARSE_CORRELATION_ID_SIZE];
+};
+
 
 BEGIN_DECL
 
-/*! allocates a client request
+/*! allocates a client request. Each thread reuses one request and its buffers, so this
+ * only allocates when the thread's request is already in use.
  * \param method the HTTP method to use
  * \param path the endpoint to use
  * \returns the allocated request
  */
 cParseRequest *cparse_request_with_method_and_path(cParseHttpRequestMethod method, const char *path);
 
+/*! resets a request for reuse, keeping its buffers
+ * \param request the request instance
+ * \param method the HTTP method to use
+ * \param path the endpoint to use
+ * \returns true if successful
+ */
+bool cparse_request_reset(cParseRequest *request, cParseHttpRequestMethod method, const char *path);
+
 /*! issues a request and returns the response data as a json object
  * \param request the request instance
  * \param error a pointer to an error that will get allocated if not successfull.
@@ -48,7 +76,7 @@ cParseJson *cparse_request_get_json(cParseRequest *request, cParseError **error)
 
 /*! adds a HTTP header to the request.
  * \param request the request instance
- * \param key the header key ex. 'Content-Type'
+ * \param key the header key ex. 'Content-Type'. It is not copied and must outlive the request.
  * \param value the header value ex 'application/json'
  */
 void cparse_request_add_header(cParseRequest *request, const char *key, const char *value);
@@ -65,16 +93,27 @@ void cparse_request_add_body(cParseRequest *request, const char *body);
  * NOTE: this will overwrite anything set with cparse_request_add_body
  * \see cparse_request_add_body
  * \param request the request instance
- * \param key the key for the value
+ * \param key the key for the value. It is not copied and must outlive the request.
  * \param value the value to send
  */
 void cparse_request_add_data(cParseRequest *request, const char *key, const char *value);
 
-/*! deallocates a request
+/*! deallocates a request, or returns it to the calling thread for reuse
  * \param request the request instance
  */
 void cparse_request_free(cParseRequest *request);
 
+/*! deallocates the calling thread's reusable request */
+void cparse_request_pool_cleanup();
+
+/*! appends text to the request body
+ * \param request the request instance
+ * \param value the text to append
+ * \param size the length of the text
+ * \returns false if out of memory
+ */
+bool cparse_request_append_body(cParseRequest *request, const char *value, size_t size);
+
 /*! performs a request
  * \param request the request instance
  * \param error a pointer to an error that will get allocated if not successful
@@ -82,8 +121,20 @@ void cparse_request_free(cParseRequest *request);
  */
 bool cparse_request_execute(cParseRequest *request, cParseError **error);
 
-cParseResponse *cparse_response_new();
-void cparse_response_free(cParseResponse *response);
+/*! empties a response, keeping its buffer */
+void cparse_response_reset(cParseResponse *response);
+
+/*! appends received text to a response
+ * \returns false if out of memory
+ */
+bool cparse_response_append(cParseResponse *response, const char *text, size_t size);
+
+/*! parses the text of a response
+ * \param response the response instance
+ * \param error a pointer to an error that will get allocated if the text is invalid or a parse error
+ * \returns the json or NULL on error
+ */
+cParseJson *cparse_response_parse_json(cParseResponse *response, cParseError **error);
 
 END_DECL
 
@@ -6,6 +6,7 @@
 #include <cparse/query.h>
 #include <cparse/user.h>
 #include <cparse/types.h>
+#include <cparse/memory.h>
 #include "protocol.h"
 #include "log.h"
 #include <stdio.h>
@@ -38,9 +39,9 @@ cParseRole *cparse_role_with_name(const char *name)
         return NULL;
     }
 
-    obj->className = strdup(CPARSE_CLASS_ROLE);
+    obj->className = cparse_strdup(CPARSE_CLASS_ROLE);
 
-    obj->urlPath = strdup(CPARSE_ROLES_PATH);
+    obj->urlPath = cparse_strdup(CPARSE_ROLES_PATH);
 
     cparse_object_set_string(obj, CPARSE_KEY_NAME, name);
 
@@ -1,17 +1,21 @@
 #include <cparse/types.h>
 #include <cparse/json.h>
 #include <cparse/util.h>
+#include <cparse/memory.h>
 #include <errno.h>
 #include "protocol.h"
 #include "log.h"
 #include <string.h>
 #include "private.h"
+#include "base64.h"
 
 
 cParseJson *cparse_pointer_from_object(cParseObject *obj)
 {
     cParseJson *data = NULL;
 
+    cparse_object_materialize(obj);
+
     if (obj == NULL || cparse_str_empty(obj->className) || cparse_str_empty(obj->objectId)) {
         cparse_log_errno(EINVAL);
         return NULL;
@@ -42,9 +46,103 @@ bool cparse_json_is_pointer(cParseJson *json)
         return false;
     }
 
-    if (!cparse_str_cmp(cparse_json_get_string(json, CPARSE_KEY_TYPE), CPARSE_TYPE_POINTER)) {
+    return !cparse_str_cmp(cparse_json_get_string(json, CPARSE_KEY_TYPE), CPARSE_TYPE_POINTER);
+}
+
+/* tests if json is a representation of a type */
+static bool cparse_json_is_type(cParseJson *json, const char *type)
+{
+    const char *value = NULL;
+
+    if (json == NULL || !cparse_json_contains(json, CPARSE_KEY_TYPE)) {
         return false;
     }
 
-    return true;
+    value = cparse_json_get_string(json, CPARSE_KEY_TYPE);
+
+    return value != NULL && !strcmp(value, type);
+}
+
+bool cparse_json_is_bytes(cParseJson *json)
+{
+    return cparse_json_is_type(json, CPARSE_TYPE_BYTES);
+}
+
+bool cparse_json_is_file(cParseJson *json)
+{
+    return cparse_json_is_type(json, CPARSE_TYPE_FILE);
+}
+
+cParseJson *cparse_bytes_from_data(const void *data, size_t size)
+{
+    cParseJson *json = NULL;
+    char *text = NULL;
+    size_t length = 0;
+
+    if (data == NULL && size > 0) {
+        cparse_log_errno(EINVAL);
+        return NULL;
+    }
+
+    length = cparse_base64_encoded_size(size);
+
+    text = cparse_malloc(length + 1);
+
+    if (text == NULL) {
+        return NULL;
+    }
+
+    text[cparse_base64_encode(text, data, size)] = 0;
+
+    json = cparse_json_new();
+
+    if (json != NULL) {
+        cparse_json_set_string(json, CPARSE_KEY_TYPE, CPARSE_TYPE_BYTES);
+
+        cparse_json_set_string(json, CPARSE_KEY_BASE64, text);
+    }
+
+    cparse_free(text);
+
+    return json;
+}
+
+void *cparse_bytes_to_data(cParseJson *json, size_t *size)
+{
+    const char *text = NULL;
+    void *data = NULL;
+    size_t length = 0, decoded = 0;
+
+    if (!cparse_json_is_bytes(json)) {
+        cparse_log_errno(EINVAL);
+        return NULL;
+    }
+
+    text = cparse_json_get_string(json, CPARSE_KEY_BASE64);
+
+    if (text == NULL) {
+        cparse_log_errno(EINVAL);
+        return NULL;
+    }
+
+    length = strlen(text);
+
+    /* at least one byte so empty data is not mistaken for an error */
+    data = cparse_malloc(cparse_base64_decoded_size(length) + 1);
+
+    if (data == NULL) {
+        return NULL;
+    }
+
+    if (!cparse_base64_decode(data, text, length, &decoded)) {
+        cparse_log_error("invalid base64 data");
+        cparse_free(data);
+        return NULL;
+    }
+
+    if (size != NULL) {
+        *size = decoded;
+    }
+
+    return data;
 }
@@ -6,6 +6,7 @@
 #include <cparse/json.h>
 #include <cparse/object.h>
 #include <cparse/util.h>
+#include <cparse/memory.h>
 #include <errno.h>
 #include "protocol.h"
 #include "client.h"
@@ -49,9 +50,9 @@ cParseUser *cparse_user_new()
         return NULL;
     }
 
-    obj->className = strdup(CPARSE_CLASS_USER);
+    obj->className = cparse_strdup(CPARSE_CLASS_USER);
 
-    obj->urlPath = strdup(CPARSE_USERS_PATH);
+    obj->urlPath = cparse_strdup(CPARSE_USERS_PATH);
 
     return obj;
 }
@@ -64,9 +65,9 @@ cParseUser *cparse_user_with_name(const char *username)
         return NULL;
     }
 
-    obj->className = strdup(CPARSE_CLASS_USER);
+    obj->className = cparse_strdup(CPARSE_CLASS_USER);
 
-    obj->urlPath = strdup(CPARSE_USERS_PATH);
+    obj->urlPath = cparse_strdup(CPARSE_USERS_PATH);
 
     cparse_object_set_string(obj, CPARSE_KEY_USER_NAME, username);
 
@@ -84,7 +85,7 @@ cParseUser *cparse_current_user(cParseError **error)
     sessionToken = cparse_client_get_session_token();
 
     if (cparse_str_empty(sessionToken)) {
-        cparse_log_set_error(error, "No valid session token");
+        cparse_log_set_error_code(error, cParseErrorInvalidSessionToken);
         return NULL;
     }
 
@@ -162,12 +163,12 @@ static bool cparse_user_login_user(cParseUser *user, cParseError **error)
     password = cparse_object_get_string(user, CPARSE_KEY_USER_PASSWORD);
 
     if (cparse_str_empty(username)) {
-        cparse_log_set_error(error, "No username provided");
+        cparse_log_set_error_code(error, cParseErrorUsernameMissing);
         return false;
     }
 
     if (cparse_str_empty(password)) {
-        cparse_log_set_error(error, "No password provided");
+        cparse_log_set_error_code(error, cParseErrorPasswordMissing);
         return false;
     }
 
@@ -197,9 +198,7 @@ static bool cparse_user_login_user(cParseUser *user, cParseError **error)
         return false;
     }
 
-    cparse_object_merge_json(user, data);
-
-    cparse_json_free(data);
+    cparse_object_adopt_json(user, data);
 
     if (cparse_object_contains(user, CPARSE_KEY_USER_SESSION_TOKEN)) {
         const char *sessionToken = cparse_object_get_string(user, CPARSE_KEY_USER_SESSION_TOKEN);
@@ -273,9 +272,9 @@ cParseQuery *cparse_user_query_new()
         return NULL;
     }
 
-    query->className = strdup(CPARSE_CLASS_USER);
+    query->className = cparse_strdup(CPARSE_CLASS_USER);
 
-    query->urlPath = strdup(CPARSE_USERS_PATH);
+    query->urlPath = cparse_strdup(CPARSE_USERS_PATH);
 
     return query;
 }
@@ -296,12 +295,12 @@ static bool cparse_user_sign_up_user(cParseUser *user, cParseError **error)
     password = cparse_object_get_string(user, CPARSE_KEY_USER_PASSWORD);
 
     if (cparse_str_empty(username)) {
-        cparse_log_set_error(error, "User has no username");
+        cparse_log_set_error_code(error, cParseErrorUsernameMissing);
         return false;
     }
 
     if (cparse_str_empty(password)) {
-        cparse_log_set_error(error, "No password provided");
+        cparse_log_set_error_code(error, cParseErrorPasswordMissing);
         return false;
     }
 
@@ -320,9 +319,7 @@ static bool cparse_user_sign_up_user(cParseUser *user, cParseError **error)
     cparse_object_remove(user, CPARSE_KEY_USER_PASSWORD);
 
     if (json != NULL) {
-        cparse_object_merge_json(user, json);
-
-        cparse_json_free(json);
+        cparse_object_adopt_json(user, json);
 
         if (cparse_object_contains(user, CPARSE_KEY_USER_SESSION_TOKEN)) {
             const char *sessionToken = cparse_object_get_string(user, CPARSE_KEY_USER_SESSION_TOKEN);
@@ -365,7 +362,7 @@ cParseUser *cparse_user_validate(const char *sessionToken, cParseError **error)
     char buf[CPARSE_BUF_SIZE + 1] = {0};
 
     if (cparse_str_empty(sessionToken)) {
-        cparse_log_set_error(error, "missing session token");
+        cparse_log_set_error_code(error, cParseErrorSessionMissing);
         return NULL;
     }
 
@@ -394,9 +391,7 @@ cParseUser *cparse_user_validate(const char *sessionToken, cParseError **error)
         return NULL;
     }
 
-    cparse_object_merge_json(user, json);
-
-    cparse_json_free(json);
+    cparse_object_adopt_json(user, json);
 
     return user;
 }
@@ -433,12 +428,12 @@ bool cparse_user_reset_password(cParseUser *user, cParseError **error)
     }
 
     if (!cparse_object_contains(user, CPARSE_KEY_USER_EMAIL)) {
-        cparse_log_set_error(error, "User has no email");
+        cparse_log_set_error_code(error, cParseErrorEmailMissing);
         return false;
     }
 
     if (!cparse_user_validate_email(user, error)) {
-        cparse_log_set_error(error, "User has no valid email");
+        cparse_log_set_error_code(error, cParseErrorInvalidEmailAddress);
         return false;
     }
 
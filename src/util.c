@@ -11,35 +11,34 @@
 #include <cparse/util.h>
 #include <cparse/json.h>
 #include <cparse/object.h>
+#include <cparse/memory.h>
 #include "log.h"
 #include "protocol.h"
 #include "private.h"
+#include "iso8601.h"
 
 inline int cparse_str_empty(const char *str)
 {
     return !str || !*str;
 }
 
-time_t cparse_date_time(const char *str)
+long long cparse_date_time_ms(const char *str)
 {
-    int y, M, d, h, m;
-    float s;
-    int tzh, tzm;
-    struct tm time;
+    long long millis = 0;
 
-    if (8 > sscanf(str, "%d-%d-%dT%d:%d:%f%d:%dZ", &y, &M, &d, &h, &m, &s, &tzh, &tzm)) {
-        sscanf(str, "%d-%d-%dT%d:%d:%fZ", &y, &M, &d, &h, &m, &s);
+    if (cparse_str_empty(str) || !cparse_iso8601_parse(str, &millis)) {
+        return 0;
     }
 
-    time.tm_year = y - 1900; /* Year since 1900 */
-    time.tm_mon = M - 1;     /* 0-11 */
-    time.tm_mday = d;        /* 1-31 */
-    time.tm_hour = h;        /* 0-23 */
-    time.tm_min = m;         /* 0-59 */
-    time.tm_sec = (int)s;    /* 0-61 */
-    time.tm_isdst = 0;       /* auto check daylight savings time */
+    return millis;
+}
+
+time_t cparse_date_time(const char *str)
+{
+    long long millis = cparse_date_time_ms(str);
 
-    return mktime(&time) - timezone;
+    /* round towards negative infinity for dates before the epoch */
+    return (time_t)(millis >= 0 ? millis / 1000 : (millis - 999) / 1000);
 }
 
 void cparse_replace_str(char **a, const char *b)
@@ -49,10 +48,10 @@ void cparse_replace_str(char **a, const char *b)
     }
 
     if (*a) {
-        free(*a);
+        cparse_free(*a);
     }
 
-    (*a) = strdup(b);
+    (*a) = cparse_strdup(b);
 }
 
 inline int cparse_str_cmp(const char *a, const char *b)
@@ -92,7 +91,7 @@ bool cparse_str_append(char **pstr, const char *append, size_t size)
 
     strSize = *pstr ? strlen(*pstr) : 0;
 
-    *pstr = realloc(*pstr, strSize + size + 1);
+    *pstr = cparse_realloc(*pstr, strSize + size + 1);
 
     if (*pstr == NULL) {
         cparse_log_errno(ENOMEM);
@@ -124,11 +123,15 @@ bool cparse_build_string(char **buf, const char *firstString, ...)
 
     while ((arg = va_arg(args, const char *)) != NULL) {
         if (!cparse_str_append(buf, arg, strlen(arg))) {
-            free(buf);
+            va_end(args);
+            cparse_free(*buf);
+            *buf = NULL;
             return false;
         }
     }
 
+    va_end(args);
+
     return true;
 }
 
@@ -139,6 +142,8 @@ void cparse_json_add_reference(cParseJson *data, cParseObject *ref)
         return;
     }
 
+    cparse_object_materialize(ref);
+
     /* set type to pointer */
     cparse_json_set_string(data, CPARSE_KEY_TYPE, CPARSE_TYPE_POINTER);
 
@@ -0,0 +1,68 @@
+#include <stdlib.h>
+#include "alloc.h"
+
+#ifdef __GLIBC__
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static __thread unsigned long bench_thread_allocs = 0;
+
+static __thread size_t bench_thread_bytes = 0;
+
+void *malloc(size_t size)
+{
+    bench_thread_allocs++;
+    bench_thread_bytes += size;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    bench_thread_allocs++;
+    bench_thread_bytes += count * size;
+    return __libc_calloc(count, size);
+}
+
+/* counts the new size, so growing a buffer counts more than it uses */
+void *realloc(void *ptr, size_t size)
+{
+    bench_thread_allocs++;
+    bench_thread_bytes += size;
+    return __libc_realloc(ptr, size);
+}
+
+int bench_alloc_supported()
+{
+    return 1;
+}
+
+unsigned long bench_alloc_count()
+{
+    return bench_thread_allocs;
+}
+
+size_t bench_alloc_bytes()
+{
+    return bench_thread_bytes;
+}
+
+#else
+
+int bench_alloc_supported()
+{
+    return 0;
+}
+
+unsigned long bench_alloc_count()
+{
+    return 0;
+}
+
+size_t bench_alloc_bytes()
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef CPARSE_BENCH_ALLOC_H_
+#define CPARSE_BENCH_ALLOC_H_
+
+#include <stddef.h>
+
+/*
+ * Counts the allocations made by the calling thread. On glibc the allocator is replaced by
+ * functions that count and forward to it, elsewhere the counts are always zero.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \returns non-zero if allocations are counted */
+int bench_alloc_supported();
+
+/*! \returns the number of allocations made by this thread */
+unsigned long bench_alloc_count();
+
+/*! \returns the number of bytes requested by this thread */
+size_t bench_alloc_bytes();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,543 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <cparse/parse.h>
+#include <cparse/object.h>
+#include <cparse/query.h>
+#include <cparse/user.h>
+#include <cparse/json.h>
+#include <cparse/error.h>
+#include "private.h"
+#include "request.h"
+#include "mock_server.h"
+#include "alloc.h"
+
+/*
+ * Measures the throughput, latency and allocations of common operations against a local mock server.
+ *
+ * usage: cparse-bench [--quick] [--iterations N] [--threads N] [--scenario NAME] [--url URL]
+ *                     [--save FILE] [--baseline FILE] [--tolerance FRACTION]
+ *
+ * --save writes the results so a later run can compare against them with --baseline, which fails
+ * if a scenario is slower or allocates more than the tolerance allows.
+ */
+
+#define BENCH_CLASS "BenchScore"
+
+#define BENCH_MAX_SCENARIOS 16
+
+#define BENCH_BATCH_SIZE 50
+
+typedef struct {
+    const char *name;
+    /* runs one operation, returns false on failure */
+    bool (*run)(void *state);
+    /* prepares the state for a thread, can be NULL */
+    void *(*setup)();
+    void (*teardown)(void *state);
+    /* the divisor of the iteration count for slower operations */
+    int scale;
+    /* runs on every thread instead of one */
+    bool concurrent;
+} cParseBenchScenario;
+
+typedef struct {
+    const char *name;
+    unsigned long ops;
+    unsigned long errors;
+    double seconds;
+    double p50;
+    double p99;
+    double allocs;
+} cParseBenchResult;
+
+typedef struct {
+    const cParseBenchScenario *scenario;
+    int iterations;
+    double *latencies;
+    unsigned long errors;
+    unsigned long allocs;
+} cParseBenchThread;
+
+static struct {
+    int iterations;
+    int threads;
+    const char *scenario;
+    const char *url;
+    const char *save;
+    const char *baseline;
+    double tolerance;
+} bench_options = {1000, 4, NULL, NULL, NULL, NULL, 0.25};
+
+static double bench_now()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static int bench_compare(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/* scenarios */
+
+static bool bench_save(void *state)
+{
+    cParseObject *obj = cparse_object_with_class_name(BENCH_CLASS);
+    cParseError *error = NULL;
+    bool rval = false;
+
+    cparse_object_set_string(obj, "playerName", "bench");
+    cparse_object_set_number(obj, "score", 1337);
+    cparse_object_set_bool(obj, "cheatMode", false);
+
+    rval = cparse_object_save(obj, &error);
+
+    if (error) {
+        cparse_error_free(error);
+    }
+
+    cparse_object_free(obj);
+
+    return rval;
+}
+
+static void *bench_fetch_setup()
+{
+    cParseObject *obj = cparse_object_with_class_name(BENCH_CLASS);
+
+    cparse_object_set_string(obj, "playerName", "bench");
+
+    if (!cparse_object_save(obj, NULL)) {
+        cparse_object_free(obj);
+        return NULL;
+    }
+
+    return obj;
+}
+
+static void bench_fetch_teardown(void *state)
+{
+    cparse_object_free((cParseObject *)state);
+}
+
+static bool bench_fetch(void *state)
+{
+    cParseError *error = NULL;
+    bool rval = false;
+
+    if (state == NULL) {
+        return false;
+    }
+
+    rval = cparse_object_refresh((cParseObject *)state, &error);
+
+    if (error) {
+        cparse_error_free(error);
+    }
+
+    return rval;
+}
+
+static bool bench_query(int limit)
+{
+    cParseQuery *query = cparse_query_with_class_name(BENCH_CLASS);
+    cParseError *error = NULL;
+    bool rval = false;
+
+    query->limit = limit;
+
+    rval = cparse_query_find_objects(query, &error) && cparse_query_size(query) == (size_t)limit;
+
+    if (error) {
+        cparse_error_free(error);
+    }
+
+    cparse_query_free(query);
+
+    return rval;
+}
+
+static bool bench_query_100(void *state)
+{
+    return bench_query(100);
+}
+
+static bool bench_query_1000(void *state)
+{
+    return bench_query(1000);
+}
+
+static bool bench_batch(void *state)
+{
+    cParseRequest *request = NULL;
+    cParseJson *batch = cparse_json_new_array();
+    cParseJson *body = cparse_json_new();
+    cParseJson *response = NULL;
+    cParseError *error = NULL;
+    bool rval = false;
+    int i;
+
+    for (i = 0; i < BENCH_BATCH_SIZE; i++) {
+        cParseJson *op = cparse_json_new();
+        cParseJson *data = cparse_json_new();
+
+        cparse_json_set_string(data, "playerName", "bench");
+        cparse_json_set_number(data, "score", i);
+
+        cparse_json_set_string(op, "method", "POST");
+        cparse_json_set_string(op, "path", "/1/classes/" BENCH_CLASS);
+        /* takes ownership */
+        cparse_json_set(op, "body", data);
+
+        cparse_json_array_add(batch, op);
+    }
+
+    cparse_json_set(body, "requests", batch);
+
+    request = cparse_request_with_method_and_path(cParseHttpRequestMethodPost, "batch");
+
+    cparse_request_add_body(request, cparse_json_to_json_string(body));
+
+    response = cparse_request_get_json(request, &error);
+
+    rval = response != NULL && cparse_json_array_size(response) == BENCH_BATCH_SIZE;
+
+    if (error) {
+        cparse_error_free(error);
+    }
+
+    cparse_json_free(response);
+    cparse_json_free(body);
+    cparse_request_free(request);
+
+    return rval;
+}
+
+static bool bench_login(void *state)
+{
+    cParseError *error = NULL;
+    cParseUser *user = cparse_user_login("bench", "bench", &error);
+
+    if (error) {
+        cparse_error_free(error);
+    }
+
+    if (user == NULL) {
+        return false;
+    }
+
+    cparse_object_free(user);
+
+    return true;
+}
+
+static const cParseBenchScenario bench_scenarios[] = {
+    {"save", bench_save, NULL, NULL, 1, false},
+    {"fetch", bench_fetch, bench_fetch_setup, bench_fetch_teardown, 1, false},
+    {"query_100", bench_query_100, NULL, NULL, 10, false},
+    {"query_1000", bench_query_1000, NULL, NULL, 100, false},
+    {"batch", bench_batch, NULL, NULL, 10, false},
+    {"login", bench_login, NULL, NULL, 1, false},
+    {"concurrent_save", bench_save, NULL, NULL, 1, true},
+    {"concurrent_fetch", bench_fetch, bench_fetch_setup, bench_fetch_teardown, 1, true},
+};
+
+#define BENCH_SCENARIO_COUNT (sizeof(bench_scenarios) / sizeof(bench_scenarios[0]))
+
+static void *bench_thread(void *arg)
+{
+    cParseBenchThread *thread = (cParseBenchThread *)arg;
+    const cParseBenchScenario *scenario = thread->scenario;
+    void *state = scenario->setup ? scenario->setup() : NULL;
+    unsigned long allocs = 0;
+    int i;
+
+    /* warm up connections and caches */
+    scenario->run(state);
+
+    allocs = bench_alloc_count();
+
+    for (i = 0; i < thread->iterations; i++) {
+        double start = bench_now();
+
+        if (!scenario->run(state)) {
+            thread->errors++;
+        }
+
+        thread->latencies[i] = bench_now() - start;
+    }
+
+    thread->allocs = bench_alloc_count() - allocs;
+
+    if (scenario->teardown) {
+        scenario->teardown(state);
+    }
+
+    return NULL;
+}
+
+static bool bench_run(const cParseBenchScenario *scenario, cParseBenchResult *result)
+{
+    int threads = scenario->concurrent ? bench_options.threads : 1;
+    int iterations = bench_options.iterations / scenario->scale;
+    cParseBenchThread *state = calloc(threads, sizeof(cParseBenchThread));
+    pthread_t *ids = calloc(threads, sizeof(pthread_t));
+    double *latencies = NULL;
+    double start = 0;
+    unsigned long allocs = 0;
+    int i;
+
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    latencies = calloc((size_t)threads * iterations, sizeof(double));
+
+    if (state == NULL || ids == NULL || latencies == NULL) {
+        free(state);
+        free(ids);
+        free(latencies);
+        return false;
+    }
+
+    memset(result, 0, sizeof(cParseBenchResult));
+
+    start = bench_now();
+
+    for (i = 0; i < threads; i++) {
+        state[i].scenario = scenario;
+        state[i].iterations = iterations;
+        state[i].latencies = latencies + (size_t)i * iterations;
+
+        if (threads == 1) {
+            bench_thread(&state[i]);
+        } else {
+            pthread_create(&ids[i], NULL, bench_thread, &state[i]);
+        }
+    }
+
+    for (i = 0; threads > 1 && i < threads; i++) {
+        pthread_join(ids[i], NULL);
+    }
+
+    result->seconds = bench_now() - start;
+
+    for (i = 0; i < threads; i++) {
+        result->errors += state[i].errors;
+        allocs += state[i].allocs;
+    }
+
+    result->name = scenario->name;
+    result->ops = (unsigned long)threads * iterations;
+
+    qsort(latencies, result->ops, sizeof(double), bench_compare);
+
+    result->p50 = latencies[result->ops / 2];
+    result->p99 = latencies[(result->ops * 99) / 100];
+    result->allocs = (double)allocs / result->ops;
+
+    free(latencies);
+    free(ids);
+    free(state);
+
+    return true;
+}
+
+/* compares results against a file written with --save, returns the number of regressions */
+static int bench_compare_baseline(const cParseBenchResult *results, size_t count)
+{
+    FILE *file = fopen(bench_options.baseline, "r");
+    char name[64];
+    double rate = 0, p50 = 0, p99 = 0, allocs = 0;
+    int regressions = 0;
+    size_t i;
+
+    if (file == NULL) {
+        perror(bench_options.baseline);
+        return 1;
+    }
+
+    while (fscanf(file, "%63s %lf %lf %lf %lf", name, &rate, &p50, &p99, &allocs) == 5) {
+        for (i = 0; i < count; i++) {
+            double current = results[i].ops / results[i].seconds;
+
+            if (strcmp(results[i].name, name)) {
+                continue;
+            }
+
+            if (current < rate * (1 - bench_options.tolerance)) {
+                printf("REGRESSION %s: %.0f ops/s, baseline %.0f ops/s\n", name, current, rate);
+                regressions++;
+            }
+
+            if (results[i].allocs > allocs * (1 + bench_options.tolerance) + 0.5) {
+                printf("REGRESSION %s: %.1f allocs/op, baseline %.1f allocs/op\n", name, results[i].allocs, allocs);
+                regressions++;
+            }
+        }
+    }
+
+    fclose(file);
+
+    return regressions;
+}
+
+static bool bench_save_results(const cParseBenchResult *results, size_t count)
+{
+    FILE *file = fopen(bench_options.save, "w");
+    size_t i;
+
+    if (file == NULL) {
+        perror(bench_options.save);
+        return false;
+    }
+
+    for (i = 0; i < count; i++) {
+        fprintf(file, "%s %f %f %f %f\n", results[i].name, results[i].ops / results[i].seconds, results[i].p50, results[i].p99,
+                results[i].allocs);
+    }
+
+    fclose(file);
+
+    return true;
+}
+
+static void bench_usage(const char *program)
+{
+    size_t i;
+
+    printf("usage: %s [--quick] [--iterations N] [--threads N] [--scenario NAME] [--url URL]\n"
+           "       [--save FILE] [--baseline FILE] [--tolerance FRACTION]\n\nscenarios:",
+           program);
+
+    for (i = 0; i < BENCH_SCENARIO_COUNT; i++) {
+        printf(" %s", bench_scenarios[i].name);
+    }
+
+    printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+    cParseMockServer *server = NULL;
+    cParseBenchResult results[BENCH_MAX_SCENARIOS];
+    size_t i, count = 0;
+    int failures = 0;
+    char url[64];
+
+    for (i = 1; i < (size_t)argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < (size_t)argc ? argv[i + 1] : NULL;
+
+        if (!strcmp(arg, "--quick")) {
+            bench_options.iterations = 100;
+            continue;
+        }
+
+        if (!strcmp(arg, "--help") || value == NULL) {
+            bench_usage(argv[0]);
+            return strcmp(arg, "--help") ? EXIT_FAILURE : EXIT_SUCCESS;
+        }
+
+        if (!strcmp(arg, "--iterations")) {
+            bench_options.iterations = atoi(value);
+        } else if (!strcmp(arg, "--threads")) {
+            bench_options.threads = atoi(value);
+        } else if (!strcmp(arg, "--scenario")) {
+            bench_options.scenario = value;
+        } else if (!strcmp(arg, "--url")) {
+            bench_options.url = value;
+        } else if (!strcmp(arg, "--save")) {
+            bench_options.save = value;
+        } else if (!strcmp(arg, "--baseline")) {
+            bench_options.baseline = value;
+        } else if (!strcmp(arg, "--tolerance")) {
+            bench_options.tolerance = atof(value);
+        } else {
+            bench_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        i++;
+    }
+
+    if (bench_options.iterations < 1 || bench_options.threads < 1) {
+        bench_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (bench_options.url == NULL) {
+        server = cparse_mock_server_start();
+
+        if (server == NULL) {
+            fprintf(stderr, "could not start mock server\n");
+            return EXIT_FAILURE;
+        }
+
+        snprintf(url, sizeof(url), "http://127.0.0.1:%d", cparse_mock_server_port(server));
+
+        bench_options.url = url;
+    }
+
+    cparse_set_application_id(getenv("PARSE_APP_ID") ? getenv("PARSE_APP_ID") : "bench");
+    cparse_set_api_key(getenv("PARSE_API_KEY") ? getenv("PARSE_API_KEY") : "bench");
+    cparse_set_server_url(bench_options.url);
+    cparse_set_log_level(cParseLogError);
+
+    printf("%-18s %10s %10s %10s %10s %12s %8s\n", "scenario", "ops", "ops/s", "p50 ms", "p99 ms", "allocs/op", "errors");
+
+    for (i = 0; i < BENCH_SCENARIO_COUNT && count < BENCH_MAX_SCENARIOS; i++) {
+        cParseBenchResult *result = &results[count];
+
+        if (bench_options.scenario && strcmp(bench_options.scenario, bench_scenarios[i].name)) {
+            continue;
+        }
+
+        if (!bench_run(&bench_scenarios[i], result)) {
+            fprintf(stderr, "%s: out of memory\n", bench_scenarios[i].name);
+            failures++;
+            continue;
+        }
+
+        printf("%-18s %10lu %10.0f %10.3f %10.3f ", result->name, result->ops, result->ops / result->seconds, result->p50 * 1000,
+               result->p99 * 1000);
+        if (bench_alloc_supported()) {
+            printf("%12.1f ", result->allocs);
+        } else {
+            printf("%12s ", "n/a");
+        }
+        printf("%8lu\n", result->errors);
+
+        if (result->errors > 0) {
+            failures++;
+        }
+
+        count++;
+    }
+
+    if (server) {
+        printf("\n%lu requests to mock server\n", cparse_mock_server_requests(server));
+    }
+
+    if (bench_options.save && !bench_save_results(results, count)) {
+        failures++;
+    }
+
+    if (bench_options.baseline) {
+        failures += bench_compare_baseline(results, count);
+    }
+
+    cparse_global_cleanup();
+
+    cparse_mock_server_stop(server);
+
+    return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,310 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <cparse/parse.h>
+#include <cparse/object.h>
+#include <cparse/json.h>
+#include <cparse/util.h>
+#include <cparse/error.h>
+#include <cparse/memory.h>
+#include "request.h"
+#include "alloc.h"
+
+/*
+ * Measures the cost of the json, date and string functions used when handling responses,
+ * against fixed corpora: a small object, a page of 1000 query results and a 1 MB bytes field.
+ *
+ * usage: cparse-microbench [--quick] [--filter TEXT]
+ */
+
+#define MICRO_PAGE_ROWS 1000
+
+#define MICRO_BYTES_SIZE (1024 * 1024)
+
+#define MICRO_DATE "2015-08-20T02:06:57.931Z"
+
+typedef struct {
+    const char *name;
+    void (*run)();
+} cParseMicroBench;
+
+static struct {
+    /* the corpora as response text */
+    cParseResponse small;
+    cParseResponse page;
+    cParseResponse bytes;
+    /* and parsed */
+    cParseJson *smallJson;
+    cParseJson *pageJson;
+    cParseJson *attributes;
+    cParseObject *obj;
+    /* the minimum time to run each benchmark */
+    double seconds;
+    const char *filter;
+} micro = {{0}};
+
+/* keeps the compiler from removing unused results */
+static volatile long micro_sink = 0;
+
+static double micro_now()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void micro_text(cParseResponse *response, const char *text)
+{
+    cparse_response_append(response, text, strlen(text));
+}
+
+static void micro_object(cParseResponse *response, int id)
+{
+    char buf[256];
+
+    snprintf(buf, sizeof(buf),
+             "{\"objectId\":\"obj%07d\",\"createdAt\":\"" MICRO_DATE "\",\"updatedAt\":\"" MICRO_DATE
+             "\",\"playerName\":\"player %d\",\"score\":%d,\"ratio\":%d.25,\"cheatMode\":%s}",
+             id, id, id * 7, id % 100, id % 2 ? "true" : "false");
+
+    micro_text(response, buf);
+}
+
+/* builds the corpora, deterministic so runs are comparable */
+static void micro_setup()
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    unsigned int seed = 1;
+    char *data = NULL;
+    size_t i;
+
+    micro_object(&micro.small, 1);
+
+    micro_text(&micro.page, "{\"results\":[");
+    for (i = 0; i < MICRO_PAGE_ROWS; i++) {
+        if (i > 0) {
+            micro_text(&micro.page, ",");
+        }
+        micro_object(&micro.page, i + 1);
+    }
+    micro_text(&micro.page, "]}");
+
+    /* base64 text of 1 MB */
+    data = malloc(MICRO_BYTES_SIZE / 3 * 4 + 1);
+
+    for (i = 0; i < MICRO_BYTES_SIZE / 3 * 4; i++) {
+        seed = seed * 1103515245 + 12345;
+        data[i] = alphabet[(seed >> 16) & 63];
+    }
+    data[i] = 0;
+
+    micro_text(&micro.bytes, "{\"objectId\":\"obj0000001\",\"data\":{\"__type\":\"Bytes\",\"base64\":\"");
+    micro_text(&micro.bytes, data);
+    micro_text(&micro.bytes, "\"}}");
+
+    free(data);
+
+    micro.smallJson = cparse_response_parse_json(&micro.small, NULL);
+    micro.pageJson = cparse_response_parse_json(&micro.page, NULL);
+
+    /* attributes only, as merging removes the object keys from its argument */
+    micro.attributes = cparse_json_new();
+    cparse_json_set_string(micro.attributes, "playerName", "player 1");
+    cparse_json_set_number(micro.attributes, "score", 7);
+    cparse_json_set_real(micro.attributes, "ratio", 1.25);
+    cparse_json_set_bool(micro.attributes, "cheatMode", true);
+
+    micro.obj = cparse_object_with_class_name("MicroBench");
+}
+
+static void micro_teardown()
+{
+    cparse_json_free(micro.smallJson);
+    cparse_json_free(micro.pageJson);
+    cparse_json_free(micro.attributes);
+    cparse_object_free(micro.obj);
+    cparse_free(micro.small.text);
+    cparse_free(micro.page.text);
+    cparse_free(micro.bytes.text);
+}
+
+/* benchmarks */
+
+static void micro_parse(cParseResponse *response)
+{
+    cParseJson *json = cparse_response_parse_json(response, NULL);
+
+    micro_sink += json != NULL;
+
+    cparse_json_free(json);
+}
+
+static void micro_parse_small()
+{
+    micro_parse(&micro.small);
+}
+
+static void micro_parse_page()
+{
+    micro_parse(&micro.page);
+}
+
+static void micro_parse_bytes()
+{
+    micro_parse(&micro.bytes);
+}
+
+static void micro_merge_small()
+{
+    cparse_object_merge_json(micro.obj, micro.attributes);
+}
+
+static void micro_copy(cParseJson *json)
+{
+    cParseJson *copy = cparse_json_new();
+
+    cparse_json_copy(copy, json, true);
+
+    micro_sink += cparse_json_num_keys(copy);
+
+    cparse_json_free(copy);
+}
+
+static void micro_copy_small()
+{
+    micro_copy(micro.smallJson);
+}
+
+static void micro_copy_page()
+{
+    micro_copy(micro.pageJson);
+}
+
+static void micro_date_time()
+{
+    micro_sink += cparse_date_time(MICRO_DATE);
+}
+
+static void micro_str_append()
+{
+    char *str = NULL;
+    int i;
+
+    for (i = 0; i < 64; i++) {
+        cparse_str_append(&str, "0123456789abcdef", 16);
+    }
+
+    micro_sink += str != NULL;
+
+    cparse_free(str);
+}
+
+static void micro_build_string()
+{
+    char *str = NULL;
+
+    cparse_build_string(&str, "https://api.parse.com", "/", "1", "/", "classes/GameScore/Ed1nuqPvcm", NULL);
+
+    micro_sink += str != NULL;
+
+    cparse_free(str);
+}
+
+static const cParseMicroBench micro_benches[] = {
+    {"parse_json_small", micro_parse_small},
+    {"parse_json_page_1000", micro_parse_page},
+    {"parse_json_bytes_1mb", micro_parse_bytes},
+    {"merge_json_small", micro_merge_small},
+    {"json_copy_small", micro_copy_small},
+    {"json_copy_page_1000", micro_copy_page},
+    {"date_time", micro_date_time},
+    {"str_append_64x16", micro_str_append},
+    {"build_string_url", micro_build_string},
+};
+
+/* runs a benchmark in doubling batches until it takes long enough to measure */
+static void micro_run(const cParseMicroBench *bench)
+{
+    unsigned long iterations = 1, i, allocs = 0;
+    size_t bytes = 0;
+    double elapsed = 0;
+
+    /* warm up */
+    bench->run();
+
+    for (;;) {
+        double start = micro_now();
+
+        allocs = bench_alloc_count();
+        bytes = bench_alloc_bytes();
+
+        for (i = 0; i < iterations; i++) {
+            bench->run();
+        }
+
+        elapsed = micro_now() - start;
+
+        allocs = bench_alloc_count() - allocs;
+        bytes = bench_alloc_bytes() - bytes;
+
+        if (elapsed >= micro.seconds || iterations >= (1UL << 30)) {
+            break;
+        }
+
+        iterations *= 2;
+    }
+
+    printf("%-24s %12lu %14.1f", bench->name, iterations, elapsed * 1e9 / iterations);
+
+    if (bench_alloc_supported()) {
+        printf(" %12.1f %14.0f\n", (double)allocs / iterations, (double)bytes / iterations);
+    } else {
+        printf(" %12s %14s\n", "n/a", "n/a");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t i;
+
+    micro.seconds = 0.5;
+
+    for (i = 1; i < (size_t)argc; i++) {
+        if (!strcmp(argv[i], "--quick")) {
+            micro.seconds = 0.05;
+        } else if (!strcmp(argv[i], "--filter") && i + 1 < (size_t)argc) {
+            micro.filter = argv[++i];
+        } else {
+            printf("usage: %s [--quick] [--filter TEXT]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    cparse_set_log_level(cParseLogError);
+
+    micro_setup();
+
+    if (micro.smallJson == NULL || micro.pageJson == NULL) {
+        fprintf(stderr, "could not parse corpora\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%-24s %12s %14s %12s %14s\n", "benchmark", "iterations", "ns/op", "allocs/op", "bytes/op");
+
+    for (i = 0; i < sizeof(micro_benches) / sizeof(micro_benches[0]); i++) {
+        if (micro.filter && !strstr(micro_benches[i].name, micro.filter)) {
+            continue;
+        }
+
+        micro_run(&micro_benches[i]);
+    }
+
+    micro_teardown();
+
+    cparse_global_cleanup();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,512 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "mock_server.h"
+
+#define MOCK_MAX_CONNECTIONS 64
+
+#define MOCK_REQUEST_SIZE (64 * 1024)
+
+/* the default number of objects returned by a query, same as parse */
+#define MOCK_QUERY_LIMIT 100
+
+#define MOCK_DATE "2015-08-20T02:06:57.931Z"
+
+typedef struct {
+    cParseMockServer *server;
+    pthread_t thread;
+    int fd;
+    /* serving a connection */
+    bool active;
+    /* the thread has not been joined */
+    bool joinable;
+} cParseMockConnection;
+
+struct cparse_mock_server {
+    int fd;
+    int port;
+    bool stopping;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    unsigned long requests;
+    unsigned long ids;
+    cParseMockConnection connections[MOCK_MAX_CONNECTIONS];
+};
+
+/* a growing response body */
+typedef struct {
+    char *text;
+    size_t size;
+    size_t capacity;
+} cParseMockBuffer;
+
+static bool mock_buffer_printf(cParseMockBuffer *buf, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+static bool mock_buffer_printf(cParseMockBuffer *buf, const char *format, ...)
+{
+    va_list args;
+    int len = 0;
+
+    for (;;) {
+        size_t avail = buf->capacity - buf->size;
+
+        va_start(args, format);
+        len = vsnprintf(buf->text ? buf->text + buf->size : NULL, avail, format, args);
+        va_end(args);
+
+        if (len < 0) {
+            return false;
+        }
+
+        if ((size_t)len < avail) {
+            buf->size += len;
+            return true;
+        }
+
+        buf->capacity = (buf->capacity + len + 1) * 2;
+        buf->text = realloc(buf->text, buf->capacity);
+
+        if (buf->text == NULL) {
+            return false;
+        }
+    }
+}
+
+static bool mock_write_all(int fd, const char *data, size_t size)
+{
+    while (size > 0) {
+        ssize_t rval = send(fd, data, size, MSG_NOSIGNAL);
+
+        if (rval < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        data += rval;
+        size -= rval;
+    }
+
+    return true;
+}
+
+static unsigned long mock_next_id(cParseMockServer *server)
+{
+    return __atomic_add_fetch(&server->ids, 1, __ATOMIC_RELAXED);
+}
+
+static void mock_object(cParseMockBuffer *body, unsigned long id)
+{
+    mock_buffer_printf(body,
+                       "{\"objectId\":\"mock%06lu\",\"createdAt\":\"" MOCK_DATE "\",\"updatedAt\":\"" MOCK_DATE
+                       "\",\"playerName\":\"player %lu\",\"score\":%lu,\"cheatMode\":false}",
+                       id, id, id % 1000);
+}
+
+static void mock_user(cParseMockServer *server, cParseMockBuffer *body)
+{
+    unsigned long id = mock_next_id(server);
+
+    mock_buffer_printf(body,
+                       "{\"objectId\":\"user%06lu\",\"username\":\"bench\",\"createdAt\":\"" MOCK_DATE "\",\"updatedAt\":\"" MOCK_DATE
+                       "\",\"sessionToken\":\"r:mock%06lu\"}",
+                       id, id);
+}
+
+/* finds an integer query parameter in a path */
+static long mock_query_param(const char *query, const char *name, long def)
+{
+    size_t len = strlen(name);
+
+    while (query != NULL && *query) {
+        if (!strncmp(query, name, len) && query[len] == '=') {
+            return strtol(query + len + 1, NULL, 10);
+        }
+
+        query = strchr(query, '&');
+
+        if (query) {
+            query++;
+        }
+    }
+
+    return def;
+}
+
+/* counts the occurences of a string */
+static int mock_count(const char *text, const char *value)
+{
+    int count = 0;
+
+    for (text = strstr(text, value); text != NULL; text = strstr(text + 1, value)) {
+        count++;
+    }
+
+    return count;
+}
+
+/* builds the response for a request, returns the status code */
+static int mock_route(cParseMockServer *server, const char *method, char *path, const char *data, cParseMockBuffer *body)
+{
+    char *query = strchr(path, '?');
+    char *id = NULL;
+    long i, limit;
+
+    if (query) {
+        *query++ = 0;
+    }
+
+    /* ignore the api version */
+    if (!strncmp(path, "/1/", 3)) {
+        path += 2;
+    }
+
+    if (!strcmp(path, "/batch")) {
+        int count = mock_count(data, "\"method\"");
+
+        mock_buffer_printf(body, "[");
+        for (i = 0; i < count; i++) {
+            mock_buffer_printf(body, "%s{\"success\":{\"objectId\":\"mock%06lu\",\"createdAt\":\"" MOCK_DATE "\"}}", i ? "," : "",
+                               mock_next_id(server));
+        }
+        mock_buffer_printf(body, "]");
+        return 200;
+    }
+
+    if (!strcmp(path, "/login") || !strcmp(path, "/users/me")) {
+        mock_user(server, body);
+        return 200;
+    }
+
+    if (!strcmp(path, "/users") && !strcmp(method, "POST")) {
+        mock_user(server, body);
+        return 201;
+    }
+
+    if (!strncmp(path, "/functions/", 11)) {
+        mock_buffer_printf(body, "{\"result\":\"ok\"}");
+        return 200;
+    }
+
+    if (strncmp(path, "/classes/", 9) && strncmp(path, "/users", 6) && strncmp(path, "/roles", 6)) {
+        mock_buffer_printf(body, "{\"code\":101,\"error\":\"object not found\"}");
+        return 404;
+    }
+
+    id = strchr(path + 1, '/');
+
+    if (id && !strncmp(path, "/classes/", 9)) {
+        id = strchr(id + 1, '/');
+    }
+
+    if (id == NULL || id[1] == 0) {
+        if (!strcmp(method, "POST")) {
+            mock_buffer_printf(body, "{\"objectId\":\"mock%06lu\",\"createdAt\":\"" MOCK_DATE "\"}", mock_next_id(server));
+            return 201;
+        }
+
+        limit = mock_query_param(query, "limit", MOCK_QUERY_LIMIT);
+
+        mock_buffer_printf(body, "{\"results\":[");
+        for (i = 0; i < limit; i++) {
+            if (i > 0) {
+                mock_buffer_printf(body, ",");
+            }
+            mock_object(body, i + 1);
+        }
+        mock_buffer_printf(body, "]");
+        if (mock_query_param(query, "count", 0)) {
+            mock_buffer_printf(body, ",\"count\":%ld", limit);
+        }
+        mock_buffer_printf(body, "}");
+        return 200;
+    }
+
+    if (!strcmp(method, "PUT")) {
+        mock_buffer_printf(body, "{\"updatedAt\":\"" MOCK_DATE "\"}");
+    } else if (!strcmp(method, "DELETE")) {
+        mock_buffer_printf(body, "{}");
+    } else {
+        mock_object(body, mock_next_id(server));
+    }
+
+    return 200;
+}
+
+/* answers requests on a connection until it is closed */
+static void *mock_connection_thread(void *arg)
+{
+    cParseMockConnection *conn = (cParseMockConnection *)arg;
+    cParseMockServer *server = conn->server;
+    char *request = malloc(MOCK_REQUEST_SIZE + 1);
+    cParseMockBuffer response = {NULL, 0, 0};
+    cParseMockBuffer body = {NULL, 0, 0};
+    size_t size = 0;
+
+    if (request == NULL) {
+        goto done;
+    }
+
+    request[0] = 0;
+
+    for (;;) {
+        char method[16] = {0}, path[2048] = {0};
+        char *end = NULL, *header = NULL;
+        size_t headerSize = 0, contentLength = 0;
+        int status = 0;
+        ssize_t rval = 0;
+
+        /* read the request line and headers */
+        while ((end = strstr(request, "\r\n\r\n")) == NULL) {
+            if (size >= MOCK_REQUEST_SIZE) {
+                goto done;
+            }
+
+            rval = recv(conn->fd, request + size, MOCK_REQUEST_SIZE - size, 0);
+
+            if (rval <= 0) {
+                goto done;
+            }
+
+            size += rval;
+            request[size] = 0;
+        }
+
+        headerSize = end - request + 4;
+
+        if (sscanf(request, "%15s %2047s", method, path) != 2) {
+            goto done;
+        }
+
+        for (header = strstr(request, "\r\n"); header && header < end; header = strstr(header + 2, "\r\n")) {
+            if (!strncasecmp(header + 2, "Content-Length:", 15)) {
+                contentLength = strtoul(header + 17, NULL, 10);
+            } else if (!strncasecmp(header + 2, "Expect: 100-continue", 20)) {
+                mock_write_all(conn->fd, "HTTP/1.1 100 Continue\r\n\r\n", 25);
+            }
+        }
+
+        if (headerSize + contentLength > MOCK_REQUEST_SIZE) {
+            goto done;
+        }
+
+        /* read the body */
+        while (size < headerSize + contentLength) {
+            rval = recv(conn->fd, request + size, MOCK_REQUEST_SIZE - size, 0);
+
+            if (rval <= 0) {
+                goto done;
+            }
+
+            size += rval;
+        }
+
+        /* the body is terminated in place, keeping the first byte of any following request */
+        {
+            char next = request[headerSize + contentLength];
+
+            request[headerSize + contentLength] = 0;
+
+            body.size = 0;
+            status = mock_route(server, method, path, request + headerSize, &body);
+
+            request[headerSize + contentLength] = next;
+        }
+
+        response.size = 0;
+        mock_buffer_printf(&response,
+                           "HTTP/1.1 %d %s\r\nContent-Type: application/json; charset=utf-8\r\nContent-Length: %zu\r\n"
+                           "Connection: keep-alive\r\n\r\n%.*s",
+                           status, status < 300 ? "OK" : "Not Found", body.size, (int)body.size, body.text);
+
+        if (!mock_write_all(conn->fd, response.text, response.size)) {
+            goto done;
+        }
+
+        __atomic_add_fetch(&server->requests, 1, __ATOMIC_RELAXED);
+
+        /* keep anything after this request */
+        size -= headerSize + contentLength;
+        memmove(request, request + headerSize + contentLength, size);
+        request[size] = 0;
+    }
+
+done:
+    free(request);
+    free(response.text);
+    free(body.text);
+
+    /* release the slot, the thread is joined when it is reused or the server stops */
+    pthread_mutex_lock(&server->lock);
+    close(conn->fd);
+    conn->fd = -1;
+    conn->active = false;
+    pthread_mutex_unlock(&server->lock);
+    return NULL;
+}
+
+static void *mock_accept_thread(void *arg)
+{
+    cParseMockServer *server = (cParseMockServer *)arg;
+
+    for (;;) {
+        int fd = accept(server->fd, NULL, NULL);
+        int i, on = 1;
+
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            break;
+        }
+
+        /* responses are written whole, don't wait to fill a segment */
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+        pthread_mutex_lock(&server->lock);
+
+        if (server->stopping) {
+            pthread_mutex_unlock(&server->lock);
+            close(fd);
+            break;
+        }
+
+        for (i = 0; i < MOCK_MAX_CONNECTIONS; i++) {
+            if (!server->connections[i].active) {
+                break;
+            }
+        }
+
+        if (i == MOCK_MAX_CONNECTIONS) {
+            pthread_mutex_unlock(&server->lock);
+            fprintf(stderr, "mock server: too many connections\n");
+            close(fd);
+            continue;
+        }
+
+        /* the last thread in the slot has finished, but still has to be joined */
+        if (server->connections[i].joinable) {
+            pthread_join(server->connections[i].thread, NULL);
+            server->connections[i].joinable = false;
+        }
+
+        server->connections[i].server = server;
+        server->connections[i].fd = fd;
+        server->connections[i].active = true;
+
+        if (pthread_create(&server->connections[i].thread, NULL, mock_connection_thread, &server->connections[i])) {
+            server->connections[i].active = false;
+            server->connections[i].fd = -1;
+            close(fd);
+        } else {
+            server->connections[i].joinable = true;
+        }
+
+        pthread_mutex_unlock(&server->lock);
+    }
+
+    return NULL;
+}
+
+cParseMockServer *cparse_mock_server_start()
+{
+    cParseMockServer *server = calloc(1, sizeof(cParseMockServer));
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    int on = 1;
+
+    if (server == NULL) {
+        return NULL;
+    }
+
+    pthread_mutex_init(&server->lock, NULL);
+
+    server->fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (server->fd < 0) {
+        perror("mock server");
+        free(server);
+        return NULL;
+    }
+
+    setsockopt(server->fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    if (bind(server->fd, (struct sockaddr *)&addr, sizeof(addr)) || listen(server->fd, MOCK_MAX_CONNECTIONS) ||
+        getsockname(server->fd, (struct sockaddr *)&addr, &len)) {
+        perror("mock server");
+        close(server->fd);
+        free(server);
+        return NULL;
+    }
+
+    server->port = ntohs(addr.sin_port);
+
+    if (pthread_create(&server->thread, NULL, mock_accept_thread, server)) {
+        close(server->fd);
+        free(server);
+        return NULL;
+    }
+
+    return server;
+}
+
+int cparse_mock_server_port(cParseMockServer *server)
+{
+    return server->port;
+}
+
+unsigned long cparse_mock_server_requests(cParseMockServer *server)
+{
+    return __atomic_load_n(&server->requests, __ATOMIC_RELAXED);
+}
+
+void cparse_mock_server_stop(cParseMockServer *server)
+{
+    int i;
+
+    if (server == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&server->lock);
+    server->stopping = true;
+    pthread_mutex_unlock(&server->lock);
+
+    /* wakes the accept thread */
+    shutdown(server->fd, SHUT_RDWR);
+    pthread_join(server->thread, NULL);
+    close(server->fd);
+
+    /* wakes the connections still being served, they close themselves */
+    pthread_mutex_lock(&server->lock);
+    for (i = 0; i < MOCK_MAX_CONNECTIONS; i++) {
+        if (server->connections[i].active) {
+            shutdown(server->connections[i].fd, SHUT_RDWR);
+        }
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    for (i = 0; i < MOCK_MAX_CONNECTIONS; i++) {
+        if (server->connections[i].joinable) {
+            pthread_join(server->connections[i].thread, NULL);
+        }
+    }
+
+    pthread_mutex_destroy(&server->lock);
+    free(server);
+}
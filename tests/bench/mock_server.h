@@ -0,0 +1,27 @@
+#ifndef CPARSE_MOCK_SERVER_H_
+#define CPARSE_MOCK_SERVER_H_
+
+#include <stdbool.h>
+
+/*
+ * A local HTTP server that answers the Parse REST endpoints used by the library
+ * with canned responses, so requests can be measured without the network or the service.
+ */
+
+typedef struct cparse_mock_server cParseMockServer;
+
+/*! starts a server on a free port of the loopback interface
+ * \returns the server or NULL on failure
+ */
+cParseMockServer *cparse_mock_server_start();
+
+/*! \returns the port the server is listening on */
+int cparse_mock_server_port(cParseMockServer *server);
+
+/*! \returns the number of requests the server has answered */
+unsigned long cparse_mock_server_requests(cParseMockServer *server);
+
+/*! closes all connections and frees the server */
+void cparse_mock_server_stop(cParseMockServer *server);
+
+#endif
@@ -1,10 +1,19 @@
 #include "client.h"
 #include "private.h"
 #include <cparse/error.h>
+#include <cparse/json.h>
+#include <cparse/parse.h>
 #include "parse.test.h"
 #include "request.h"
 #include "data_list.h"
+#include "log.h"
 #include <check.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 
 static void cparse_test_setup()
 {
@@ -22,18 +31,309 @@ START_TEST(test_cparse_client_payload)
 
     cparse_request_add_body(request, "key=value");
 
-    fail_unless(request->data != NULL);
+    fail_unless(cparse_dlist_size(&request->data) == 1);
 
-    fail_unless(request->data->next == NULL);
+    fail_unless(cparse_dlist_key(&request->data, 0) == NULL);
 
-    fail_unless(request->data->key == NULL);
+    fail_unless(!strcmp(cparse_dlist_value(&request->data, 0), "key=value"));
 
-    fail_unless(!strcmp(request->data->value, "key=value"));
+    cparse_request_add_data(request, "key", "value");
+
+    cparse_request_add_data(request, "other", "value2");
+
+    fail_unless(cparse_dlist_size(&request->data) == 2);
+
+    fail_unless(!strcmp(cparse_dlist_key(&request->data, 1), "other"));
+
+    fail_unless(!strcmp(cparse_dlist_value(&request->data, 1), "value2"));
+
+    cparse_request_free(request);
+}
+END_TEST
+
+START_TEST(test_cparse_client_request_reuse)
+{
+    cParseRequest *request = cparse_request_with_method_and_path(cParseHttpRequestMethodGet, "users");
+    cParseRequest *other = NULL;
+    const char *password = NULL;
+
+    cparse_request_add_data(request, "key", "value");
+
+    /* a request in progress is not reused */
+    other = cparse_request_with_method_and_path(cParseHttpRequestMethodPost, "classes/Test");
+
+    fail_unless(other != request);
+
+    cparse_request_free(other);
+
+    cparse_request_add_data(request, "password", "secret");
+
+    password = cparse_dlist_value(&request->data, 1);
+
+    cparse_request_add_header(request, "X-Test", "header");
+
+    cparse_request_free(request);
+
+    /* nothing is left in the kept storage */
+    fail_unless(cparse_dlist_size(&request->data) == 0);
+
+    fail_unless(cparse_dlist_size(&request->headers) == 0);
+
+    fail_unless(*password == 0);
+
+    fail_unless(request->headers.values[0] == 0);
+
+    /* the next request on this thread is */
+    other = cparse_request_with_method_and_path(cParseHttpRequestMethodPost, "classes/Test");
+
+    fail_unless(other == request);
+
+    fail_unless(!strcmp(other->path, "classes/Test"));
+
+    fail_unless(other->method == cParseHttpRequestMethodPost);
+
+    fail_unless(cparse_dlist_size(&other->data) == 0);
+
+    cparse_request_free(other);
+}
+END_TEST
+
+START_TEST(test_cparse_client_data_list)
+{
+    cParseDataList list;
+    char value[64];
+    int i;
+
+    cparse_dlist_init(&list);
+
+    /* grow past the inline entries and value bytes */
+    for (i = 0; i < 40; i++) {
+        snprintf(value, sizeof(value), "a value that is long enough to spill %d", i);
+
+        fail_unless(cparse_dlist_add(&list, "key", value));
+    }
+
+    fail_unless(cparse_dlist_size(&list) == 40);
+
+    fail_unless(!strcmp(cparse_dlist_value(&list, 0), "a value that is long enough to spill 0"));
+
+    fail_unless(!strcmp(cparse_dlist_value(&list, 39), "a value that is long enough to spill 39"));
+
+    fail_unless(cparse_dlist_value(&list, 40) == NULL);
+
+    cparse_dlist_clear(&list);
+
+    fail_unless(cparse_dlist_size(&list) == 0);
+
+    fail_unless(cparse_dlist_add(&list, NULL, "body"));
+
+    fail_unless(!strcmp(cparse_dlist_value(&list, 0), "body"));
+
+    cparse_dlist_destroy(&list);
+}
+END_TEST
+
+/* the order of trace events seen by the hooks */
+static char cparse_test_trace_events[16];
+static unsigned long cparse_test_trace_id = 0;
+
+static void cparse_test_trace(const cParseTraceEvent *event, void *param)
+{
+    size_t len = strlen(cparse_test_trace_events);
+
+    if (len < sizeof(cparse_test_trace_events) - 1) {
+        cparse_test_trace_events[len] = *(const char *)param;
+    }
+
+    fail_unless(event->requestId == cparse_test_trace_id);
+
+    fail_unless(!strcmp(event->correlationId, "trace-id"));
+
+    fail_unless(event->elapsed >= 0);
+}
+
+static void cparse_test_trace_enqueue(const cParseTraceEvent *event, void *param)
+{
+    cparse_test_trace_id = event->requestId;
+
+    cparse_test_trace(event, "e");
+}
+
+static void cparse_test_trace_start(const cParseTraceEvent *event, void *param)
+{
+    cparse_test_trace(event, "s");
+}
+
+static void cparse_test_trace_first_byte(const cParseTraceEvent *event, void *param)
+{
+    cparse_test_trace(event, "f");
+}
+
+static void cparse_test_trace_complete(const cParseTraceEvent *event, void *param)
+{
+    cparse_test_trace(event, "c");
+}
+
+static const char *cparse_test_trace_correlation_id(unsigned long requestId, void *param)
+{
+    return "trace-id";
+}
+
+START_TEST(test_cparse_client_trace_hooks)
+{
+    cParseTraceHooks hooks = {0};
+    cParseError *error = NULL;
+    cParseRequest *request = NULL;
+    cParseJson *json = NULL;
+
+    hooks.onEnqueue = cparse_test_trace_enqueue;
+    hooks.onStart = cparse_test_trace_start;
+    hooks.onFirstByte = cparse_test_trace_first_byte;
+    hooks.onComplete = cparse_test_trace_complete;
+    hooks.correlationId = cparse_test_trace_correlation_id;
+
+    cparse_set_trace_hooks(&hooks);
+
+    cparse_set_correlation_header("X-Request-Id");
+
+    memset(cparse_test_trace_events, 0, sizeof(cparse_test_trace_events));
+
+    request = cparse_request_with_method_and_path(cParseHttpRequestMethodGet, "classes/" TEST_CLASS);
+
+    json = cparse_request_get_json(request, &error);
+
+    fail_unless(error == NULL);
+
+    fail_unless(!strcmp(cparse_test_trace_events, "esfc"));
+
+    cparse_json_free(json);
 
     cparse_request_free(request);
+
+    cparse_set_trace_hooks(NULL);
+
+    cparse_set_correlation_header(NULL);
 }
 END_TEST
 
+static void cparse_test_count_retry(const cParseTraceEvent *event, void *param)
+{
+    (*(int *)param)++;
+}
+
+/* sends a request to a server url, returning how many times it was retried */
+static int cparse_test_retries(const char *url)
+{
+    cParseTraceHooks hooks = {0};
+    cParseError *error = NULL;
+    cParseRequest *request = NULL;
+    cParseJson *json = NULL;
+    int retries = 0;
+
+    hooks.onRetry = cparse_test_count_retry;
+    hooks.param = &retries;
+
+    cparse_set_trace_hooks(&hooks);
+
+    cparse_set_server_url(url);
+
+    request = cparse_request_with_method_and_path(cParseHttpRequestMethodGet, "classes/" TEST_CLASS);
+
+    json = cparse_request_get_json(request, &error);
+
+    fail_unless(json == NULL);
+
+    if (error) {
+        cparse_error_free(error);
+    }
+
+    cparse_request_free(request);
+
+    cparse_set_server_url(NULL);
+
+    cparse_set_trace_hooks(NULL);
+
+    return retries;
+}
+
+/* builds a local url with a port that was just released, so nothing listens on it */
+static void cparse_test_closed_url(char *url, size_t size)
+{
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    fail_unless(fd != -1);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    fail_unless(bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+
+    fail_unless(getsockname(fd, (struct sockaddr *)&addr, &len) == 0);
+
+    close(fd);
+
+    snprintf(url, size, "http://127.0.0.1:%d", ntohs(addr.sin_port));
+}
+
+START_TEST(test_cparse_client_retries)
+{
+    char url[BUFSIZ];
+
+    cparse_set_request_retries(2);
+
+    /* a connection that is refused is retried */
+    cparse_test_closed_url(url, sizeof(url));
+
+    fail_unless(cparse_test_retries(url) == 2);
+
+    /* a bad url won't get better */
+    fail_unless(cparse_test_retries("http://[invalid") == 0);
+
+    cparse_set_request_retries(0);
+}
+END_TEST
+
+/* keeps the function of the first request record */
+static void cparse_test_request_log_sink(const cParseLogRecord *record, void *param)
+{
+    if (record->method != NULL && *(char *)param == 0) {
+        snprintf((char *)param, BUFSIZ, "%s %s", record->function, record->method);
+    }
+}
+
+START_TEST(test_cparse_client_log_request)
+{
+    char first[BUFSIZ + 1] = {0};
+    cParseLogLevel level = cparse_current_log_level;
+    cParseError *error = NULL;
+    cParseRequest *request = NULL;
+    cParseJson *json = NULL;
+
+    cparse_set_log_sink(cparse_test_request_log_sink, first);
+
+    cparse_set_log_level(cParseLogDebug);
+
+    request = cparse_request_with_method_and_path(cParseHttpRequestMethodGet, "classes/" TEST_CLASS);
+
+    json = cparse_request_get_json(request, &error);
+
+    cparse_set_log_sink(NULL, NULL);
+
+    cparse_set_log_level(level);
+
+    fail_unless(error == NULL);
+
+    /* each attempt is logged where it is sent, not under the one name records used to have */
+    fail_unless(!strcmp(first, "cparse_client_perform GET"));
+
+    cparse_json_free(json);
+
+    cparse_request_free(request);
+}
+END_TEST
 
 START_TEST(test_cparse_client_bad_request)
 {
@@ -60,7 +360,12 @@ Suite *cparse_client_suite(void)
     TCase *tc = tcase_create("Request");
     tcase_add_checked_fixture(tc, cparse_test_setup, cparse_test_teardown);
     tcase_add_test(tc, test_cparse_client_payload);
+    tcase_add_test(tc, test_cparse_client_data_list);
+    tcase_add_test(tc, test_cparse_client_request_reuse);
     tcase_add_test(tc, test_cparse_client_bad_request);
+    tcase_add_test(tc, test_cparse_client_trace_hooks);
+    tcase_add_test(tc, test_cparse_client_retries);
+    tcase_add_test(tc, test_cparse_client_log_request);
     suite_add_tcase(s, tc);
 
     return s;
@@ -4,6 +4,7 @@
 #include <cparse/parse.h>
 #include <cparse/json.h>
 #include <cparse/util.h>
+#include <cparse/memory.h>
 
 extern const char *cparse_app_id;
 extern const char *cparse_api_key;
@@ -86,10 +87,10 @@ bool is_valid_config()
 void cleanup()
 {
     if (cparse_app_id) {
-        free((char *)cparse_app_id);
+        cparse_free((char *)cparse_app_id);
     }
 
     if (cparse_api_key) {
-        free((char *)cparse_api_key);
+        cparse_free((char *)cparse_api_key);
     }
 }
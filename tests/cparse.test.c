@@ -17,6 +17,9 @@ Suite *cparse_user_suite();
 Suite *cparse_client_suite();
 Suite *cparse_acl_suite();
 Suite *cparse_role_suite();
+Suite *cparse_metrics_suite();
+Suite *cparse_memory_suite();
+Suite *cparse_types_suite();
 
 extern int cparse_cleanup_test_objects();
 
@@ -49,6 +52,9 @@ int main(void)
     srunner_add_suite(sr, cparse_client_suite());
     srunner_add_suite(sr, cparse_acl_suite());
     srunner_add_suite(sr, cparse_role_suite());
+    srunner_add_suite(sr, cparse_metrics_suite());
+    srunner_add_suite(sr, cparse_memory_suite());
+    srunner_add_suite(sr, cparse_types_suite());
     srunner_run_all(sr, CK_ENV);
     number_failed = srunner_ntests_failed(sr);
     srunner_free(sr);
@@ -0,0 +1,168 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cparse/memory.h>
+#include <cparse/parse.h>
+#include <cparse/util.h>
+
+extern const char *cparse_app_id;
+extern const char *cparse_api_key;
+
+static void cparse_test_setup()
+{
+    cparse_set_memory_limit(0);
+}
+
+static void cparse_test_teardown()
+{
+    cparse_set_memory_limit(0);
+}
+
+START_TEST(test_cparse_memory_stats)
+{
+    cParseMemoryStats before, after;
+    char *str = NULL;
+
+    cparse_memory_stats(&before);
+
+    str = cparse_strdup("hello");
+
+    fail_unless(str != NULL);
+
+    fail_unless(cparse_str_append(&str, " world", 6));
+
+    fail_unless(!strcmp(str, "hello world"));
+
+    cparse_memory_stats(&after);
+
+    fail_unless(after.liveBytes == before.liveBytes + 12);
+
+    fail_unless(after.liveAllocations == before.liveAllocations + 1);
+
+    fail_unless(after.allocations == before.allocations + 2);
+
+    fail_unless(after.peakBytes >= after.liveBytes);
+
+    cparse_free(str);
+
+    cparse_memory_stats(&after);
+
+    fail_unless(after.liveBytes == before.liveBytes);
+
+    fail_unless(after.liveAllocations == before.liveAllocations);
+}
+END_TEST
+
+START_TEST(test_cparse_memory_limit)
+{
+    cParseMemoryStats stats;
+    char *small = NULL;
+    unsigned long failures = 0;
+
+    cparse_memory_stats(&stats);
+
+    failures = stats.failures;
+
+    cparse_set_memory_limit(stats.liveBytes + 1024);
+
+    fail_unless(cparse_malloc(4096) == NULL);
+
+    small = cparse_malloc(512);
+
+    fail_unless(small != NULL);
+
+    /* a failed resize keeps the memory */
+    fail_unless(cparse_realloc(small, 4096) == NULL);
+
+    small = cparse_realloc(small, 256);
+
+    fail_unless(small != NULL);
+
+    cparse_free(small);
+
+    cparse_memory_stats(&stats);
+
+    fail_unless(stats.failures == failures + 2);
+}
+END_TEST
+
+static unsigned long cparse_test_allocations = 0;
+
+static void *cparse_test_allocate(size_t size, void *param)
+{
+    (*(unsigned long *)param)++;
+    return malloc(size);
+}
+
+static void *cparse_test_reallocate(void *ptr, size_t size, void *param)
+{
+    return realloc(ptr, size);
+}
+
+static void cparse_test_release(void *ptr, void *param)
+{
+    free(ptr);
+}
+
+START_TEST(test_cparse_memory_allocator)
+{
+    cParseAllocator allocator = {cparse_test_allocate, cparse_test_reallocate, cparse_test_release, &cparse_test_allocations};
+    cParseMemoryStats stats;
+    void *ptr = NULL;
+    char *appId = cparse_app_id ? strdup(cparse_app_id) : NULL;
+    char *apiKey = cparse_api_key ? strdup(cparse_api_key) : NULL;
+
+    /* the allocator can't change while memory is allocated with the last one */
+    ptr = cparse_malloc(1);
+
+    fail_unless(!cparse_set_allocator(&allocator));
+
+    cparse_free(ptr);
+
+    /* release what the test setup allocated */
+    cparse_global_cleanup();
+
+    cparse_memory_stats(&stats);
+
+    fail_unless(stats.liveAllocations == 0);
+
+    fail_unless(cparse_set_allocator(&allocator));
+
+    ptr = cparse_calloc(4, 8);
+
+    fail_unless(ptr != NULL);
+
+    fail_unless(cparse_test_allocations == 1);
+
+    fail_unless(!cparse_set_allocator(NULL));
+
+    cparse_free(ptr);
+
+    fail_unless(cparse_set_allocator(NULL));
+
+    cparse_set_application_id(appId);
+    cparse_set_api_key(apiKey);
+
+    free(appId);
+    free(apiKey);
+}
+END_TEST
+
+Suite *cparse_memory_suite(void)
+{
+    Suite *s = suite_create("Memory");
+
+    TCase *tc = tcase_create("Memory");
+    tcase_add_checked_fixture(tc, cparse_test_setup, cparse_test_teardown);
+    tcase_add_test(tc, test_cparse_memory_stats);
+    tcase_add_test(tc, test_cparse_memory_limit);
+    suite_add_tcase(s, tc);
+
+    /* no fixture, it needs the library to have nothing allocated */
+    tc = tcase_create("Allocator");
+    tcase_add_test(tc, test_cparse_memory_allocator);
+    suite_add_tcase(s, tc);
+
+    return s;
+}
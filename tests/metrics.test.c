@@ -0,0 +1,108 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cparse/metrics.h>
+#include <cparse/memory.h>
+#include "metrics.h"
+
+static void cparse_test_setup()
+{
+    cparse_metrics_reset();
+}
+
+static void cparse_test_teardown()
+{
+    cparse_metrics_reset();
+}
+
+START_TEST(test_cparse_metrics_endpoint)
+{
+    fail_unless(cparse_metrics_endpoint("classes/GameScore/abc") == cParseEndpointObjects);
+
+    fail_unless(cparse_metrics_endpoint("login") == cParseEndpointLogin);
+
+    fail_unless(cparse_metrics_endpoint("users/me") == cParseEndpointUsers);
+
+    fail_unless(cparse_metrics_endpoint("functions/hello") == cParseEndpointFunctions);
+
+    fail_unless(cparse_metrics_endpoint("batch") == cParseEndpointBatch);
+
+    fail_unless(cparse_metrics_endpoint("roles") == cParseEndpointOther);
+}
+END_TEST
+
+START_TEST(test_cparse_metrics_record)
+{
+    cParseMetricsSample sample = {cParseEndpointObjects, false, 100, 2000, {0.002, 0.01, 0.03, 0.2, 0.3}};
+    cParseMetrics metrics;
+    const cParseHistogram *total = NULL;
+
+    cparse_metrics_record(&sample);
+
+    sample.error = true;
+    sample.timings[cParseTimingTotal] = 10;
+
+    cparse_metrics_record(&sample);
+
+    cparse_metrics_snapshot(&metrics);
+
+    fail_unless(metrics.endpoints[cParseEndpointObjects].requests == 2);
+
+    fail_unless(metrics.endpoints[cParseEndpointObjects].errors == 1);
+
+    fail_unless(metrics.endpoints[cParseEndpointObjects].bytesSent == 200);
+
+    fail_unless(metrics.endpoints[cParseEndpointObjects].bytesReceived == 4000);
+
+    fail_unless(metrics.endpoints[cParseEndpointUsers].requests == 0);
+
+    total = &metrics.endpoints[cParseEndpointObjects].timings[cParseTimingTotal];
+
+    fail_unless(total->count == 2);
+
+    /* 0.3 is in the 0.5 bucket, 10 is past the last bound */
+    fail_unless(cparse_metrics_bucket(8) == 0.5);
+
+    fail_unless(total->buckets[8] == 1);
+
+    fail_unless(total->buckets[CPARSE_METRICS_BUCKETS] == 1);
+}
+END_TEST
+
+START_TEST(test_cparse_metrics_prometheus)
+{
+    cParseMetricsSample sample = {cParseEndpointLogin, false, 10, 20, {0, 0, 0, 0.2, 0.3}};
+    char *text = NULL;
+
+    cparse_metrics_record(&sample);
+
+    text = cparse_metrics_to_prometheus();
+
+    fail_unless(text != NULL);
+
+    fail_unless(strstr(text, "cparse_requests_total{endpoint=\"login\"} 1\n") != NULL);
+
+    fail_unless(strstr(text, "cparse_response_bytes_total{endpoint=\"login\"} 20\n") != NULL);
+
+    fail_unless(strstr(text, "cparse_request_duration_seconds_bucket{endpoint=\"login\",phase=\"total\",le=\"0.5\"} 1\n") != NULL);
+
+    fail_unless(strstr(text, "cparse_request_duration_seconds_count{endpoint=\"login\",phase=\"total\"} 1\n") != NULL);
+
+    cparse_free(text);
+}
+END_TEST
+
+Suite *cparse_metrics_suite(void)
+{
+    Suite *s = suite_create("Metrics");
+
+    TCase *tc = tcase_create("Metrics");
+    tcase_add_checked_fixture(tc, cparse_test_setup, cparse_test_teardown);
+    tcase_add_test(tc, test_cparse_metrics_endpoint);
+    tcase_add_test(tc, test_cparse_metrics_record);
+    tcase_add_test(tc, test_cparse_metrics_prometheus);
+    suite_add_tcase(s, tc);
+
+    return s;
+}
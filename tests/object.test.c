@@ -8,6 +8,8 @@
 #include <cparse/parse.h>
 #include <cparse/json.h>
 #include <cparse/error.h>
+#include <cparse/memory.h>
+#include <cparse/metrics.h>
 
 #include "private.h"
 
@@ -149,6 +151,51 @@ START_TEST(test_cparse_object_fetch)
 }
 END_TEST
 
+START_TEST(test_cparse_object_fetch_pointers)
+{
+    cParseObject *objs[2];
+
+    cParseObject *partner = cparse_new_test_object("user2", 1444);
+
+    cParseJson *data = NULL;
+
+    cParseError *error = NULL;
+
+    cParseMetrics metrics;
+
+    fail_unless(cparse_save_test_object(partner));
+
+    objs[0] = cparse_new_test_object("user1", 1234);
+
+    objs[1] = cparse_new_test_object("user3", 4321);
+
+    /* both objects point to the same partner, which should be fetched once */
+    cparse_object_set_reference(objs[0], "partner", partner);
+
+    cparse_object_set_reference(objs[1], "partner", partner);
+
+    cparse_metrics_reset();
+
+    fail_unless(cparse_object_fetch_pointers(objs, 2, &error));
+
+    fail_unless(error == NULL);
+
+    cparse_metrics_snapshot(&metrics);
+
+    fail_unless(metrics.endpoints[cParseEndpointObjects].requests == 1);
+
+    data = cparse_object_get(objs[0], "partner");
+
+    fail_unless(cparse_json_num_keys(data) > 3);
+
+    fail_unless(!strcmp(cparse_json_get_string(data, "__type"), "Object"));
+
+    fail_unless(data == cparse_object_get(objs[1], "partner"));
+
+    fail_unless(cparse_json_get_number(data, "score", 0) == 1444);
+}
+END_TEST
+
 START_TEST(test_cparse_object_refresh)
 {
     cParseError *error = NULL;
@@ -167,7 +214,7 @@ START_TEST(test_cparse_object_refresh)
 
     fail_unless(rval);
 
-    obj2->objectId = strdup(obj->objectId);
+    obj2->objectId = cparse_strdup(obj->objectId);
 
     rval = cparse_object_refresh(obj2, &error);
 
@@ -266,6 +313,31 @@ START_TEST(test_cparse_object_to_json)
 }
 END_TEST
 
+START_TEST(test_cparse_object_adopt_json)
+{
+    cParseObject *cp_obj = cparse_object_with_class_name(TEST_CLASS);
+
+    cParseJson *json = cparse_json_tokenize("{\"objectId\":\"abc123\",\"createdAt\":\"2011-08-20T02:06:57.931Z\",\"main\":\"Hello\"}");
+
+    fail_unless(json != NULL);
+
+    cparse_object_adopt_json(cp_obj, json);
+
+    /* the response becomes the attributes */
+    fail_unless(cp_obj->attributes == json);
+
+    fail_unless(!strcmp(cparse_object_id(cp_obj), "abc123"));
+
+    fail_unless(cparse_object_created_at(cp_obj) == 1313806017);
+
+    fail_unless(cparse_object_attribute_size(cp_obj) == 1);
+
+    fail_unless(!strcmp(cparse_object_get_string(cp_obj, "main"), "Hello"));
+
+    cparse_object_free(cp_obj);
+}
+END_TEST
+
 START_TEST(test_cparse_object_update)
 {
     cParseObject *obj = cparse_new_test_object("blah", 1234);
@@ -365,12 +437,14 @@ Suite *cparse_object_suite(void)
     tcase_add_test(tc, test_cparse_object_count_attributes);
     tcase_add_test(tc, test_cparse_object_remove_attribute);
     tcase_add_test(tc, test_cparse_object_to_json);
+    tcase_add_test(tc, test_cparse_object_adopt_json);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("Refresh/Fetch");
     tcase_add_checked_fixture(tc, cparse_test_setup, cparse_test_teardown);
     tcase_add_test(tc, test_cparse_object_fetch);
     tcase_add_test(tc, test_cparse_object_refresh);
+    tcase_add_test(tc, test_cparse_object_fetch_pointers);
     tcase_set_timeout(tc, 30);
     suite_add_tcase(s, tc);
 
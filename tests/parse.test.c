@@ -1,11 +1,15 @@
 #include <check.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
 #include <cparse/error.h>
+#include <cparse/memory.h>
 #include <cparse/parse.h>
 #include <cparse/object.h>
 #include "parse.test.h"
 #include "client.h"
+#include "log.h"
 
 extern const char *cparse_app_id;
 
@@ -147,6 +151,401 @@ static void cparse_test_teardown()
 {
 }
 
+static void cparse_test_log_sink(const cParseLogRecord *record, void *param)
+{
+    cParseLogRecord *last = (cParseLogRecord *)param;
+
+    *last = *record;
+
+    /* only valid for the call */
+    last->message = strdup(record->message);
+}
+
+START_TEST(test_cparse_log_sink)
+{
+    cParseLogRecord last = {0};
+    cParseLogLevel level = cparse_current_log_level;
+
+    cparse_set_log_sink(cparse_test_log_sink, &last);
+
+    cparse_set_log_level(cParseLogWarn);
+
+    cparse_log_info("not logged");
+
+    fail_unless(last.message == NULL);
+
+    cparse_log_warn("logged %d", 1234);
+
+    cparse_set_log_sink(NULL, NULL);
+
+    cparse_set_log_level(level);
+
+    fail_unless(last.level == cParseLogWarn);
+
+    /* check may add a suffix to test function names */
+    fail_unless(strstr(last.function, "test_cparse_log_sink") == last.function);
+
+    fail_unless(!strcmp(last.message, "logged 1234"));
+
+    fail_unless(last.method == NULL);
+
+    free((char *)last.message);
+}
+END_TEST
+
+#define CPARSE_TEST_LOG_THREADS 2
+
+/* no more than a thread's ring holds, so none are dropped */
+#define CPARSE_TEST_LOG_MESSAGES 100
+
+/* more than a thread's ring holds */
+#define CPARSE_TEST_LOG_OVERFLOW 1000
+
+typedef struct {
+    int received[CPARSE_TEST_LOG_THREADS][CPARSE_TEST_LOG_MESSAGES];
+    int count;
+} cParseTestLogCount;
+
+/* called on the writer thread */
+static void cparse_test_log_count_sink(const cParseLogRecord *record, void *param)
+{
+    cParseTestLogCount *count = (cParseTestLogCount *)param;
+    int thread = 0, message = 0;
+
+    if (sscanf(record->message, "thread %d message %d", &thread, &message) == 2 && thread >= 0 && thread < CPARSE_TEST_LOG_THREADS &&
+        message >= 0 && message < CPARSE_TEST_LOG_MESSAGES) {
+        count->received[thread][message]++;
+    }
+
+    count->count++;
+}
+
+static void *cparse_test_log_thread(void *arg)
+{
+    int thread = *(int *)arg, i;
+
+    for (i = 0; i < CPARSE_TEST_LOG_MESSAGES; i++) {
+        cparse_log_info("thread %d message %d", thread, i);
+    }
+
+    return NULL;
+}
+
+START_TEST(test_cparse_log_async)
+{
+    static cParseTestLogCount count;
+    pthread_t threads[CPARSE_TEST_LOG_THREADS];
+    int ids[CPARSE_TEST_LOG_THREADS];
+    cParseLogLevel level = cparse_current_log_level;
+    unsigned long dropped = cparse_log_dropped_count();
+    int i, j;
+
+    memset(&count, 0, sizeof(count));
+
+    cparse_set_log_sink(cparse_test_log_count_sink, &count);
+
+    cparse_set_log_level(cParseLogInfo);
+
+    cparse_enable_async_logging(true);
+
+    for (i = 0; i < CPARSE_TEST_LOG_THREADS; i++) {
+        ids[i] = i;
+
+        fail_unless(pthread_create(&threads[i], NULL, cparse_test_log_thread, &ids[i]) == 0);
+    }
+
+    for (i = 0; i < CPARSE_TEST_LOG_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    /* stops the writer after it has written everything queued */
+    cparse_log_cleanup();
+
+    cparse_set_log_sink(NULL, NULL);
+
+    cparse_set_log_level(level);
+
+    fail_unless(count.count == CPARSE_TEST_LOG_THREADS * CPARSE_TEST_LOG_MESSAGES);
+
+    for (i = 0; i < CPARSE_TEST_LOG_THREADS; i++) {
+        for (j = 0; j < CPARSE_TEST_LOG_MESSAGES; j++) {
+            fail_unless(count.received[i][j] == 1);
+        }
+    }
+
+    fail_unless(cparse_log_dropped_count() == dropped);
+}
+END_TEST
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int blocked;
+    int released;
+} cParseTestLogGate;
+
+/* holds up the writer thread on the first record until released */
+static void cparse_test_log_gate_sink(const cParseLogRecord *record, void *param)
+{
+    cParseTestLogGate *gate = (cParseTestLogGate *)param;
+
+    pthread_mutex_lock(&gate->lock);
+
+    gate->blocked = 1;
+
+    pthread_cond_broadcast(&gate->cond);
+
+    while (!gate->released) {
+        pthread_cond_wait(&gate->cond, &gate->lock);
+    }
+
+    pthread_mutex_unlock(&gate->lock);
+}
+
+START_TEST(test_cparse_log_dropped)
+{
+    static cParseTestLogGate gate = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0};
+    cParseLogLevel level = cparse_current_log_level;
+    unsigned long dropped = cparse_log_dropped_count();
+    int i;
+
+    cparse_set_log_sink(cparse_test_log_gate_sink, &gate);
+
+    cparse_set_log_level(cParseLogInfo);
+
+    cparse_enable_async_logging(true);
+
+    cparse_log_info("blocks the writer");
+
+    pthread_mutex_lock(&gate.lock);
+
+    while (!gate.blocked) {
+        pthread_cond_wait(&gate.cond, &gate.lock);
+    }
+
+    pthread_mutex_unlock(&gate.lock);
+
+    /* nothing is read while the writer is blocked, so the ring fills */
+    for (i = 0; i < CPARSE_TEST_LOG_OVERFLOW; i++) {
+        cparse_log_info("message %d", i);
+    }
+
+    pthread_mutex_lock(&gate.lock);
+
+    gate.released = 1;
+
+    pthread_cond_broadcast(&gate.cond);
+
+    pthread_mutex_unlock(&gate.lock);
+
+    cparse_log_cleanup();
+
+    cparse_set_log_sink(NULL, NULL);
+
+    cparse_set_log_level(level);
+
+    fail_unless(cparse_log_dropped_count() > dropped);
+}
+END_TEST
+
+static void *cparse_test_log_once(void *arg)
+{
+    cparse_log_info("first message on a new thread");
+
+    return NULL;
+}
+
+START_TEST(test_cparse_log_blocked_sink)
+{
+    static cParseTestLogGate gate = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0};
+    cParseLogLevel level = cparse_current_log_level;
+    pthread_t thread;
+
+    cparse_set_log_sink(cparse_test_log_gate_sink, &gate);
+
+    cparse_set_log_level(cParseLogInfo);
+
+    cparse_enable_async_logging(true);
+
+    cparse_log_info("blocks the writer");
+
+    pthread_mutex_lock(&gate.lock);
+
+    while (!gate.blocked) {
+        pthread_cond_wait(&gate.cond, &gate.lock);
+    }
+
+    pthread_mutex_unlock(&gate.lock);
+
+    /* a thread logging for the first time doesn't wait on the blocked sink */
+    fail_unless(pthread_create(&thread, NULL, cparse_test_log_once, NULL) == 0);
+
+    pthread_join(thread, NULL);
+
+    pthread_mutex_lock(&gate.lock);
+
+    gate.released = 1;
+
+    pthread_cond_broadcast(&gate.cond);
+
+    pthread_mutex_unlock(&gate.lock);
+
+    cparse_log_cleanup();
+
+    cparse_set_log_sink(NULL, NULL);
+
+    cparse_set_log_level(level);
+}
+END_TEST
+
+/* logs through cparse from the writer thread, which has no ring of its own */
+static void cparse_test_log_logging_sink(const cParseLogRecord *record, void *param)
+{
+    int *count = (int *)param;
+
+    if (strcmp(record->message, "from the sink")) {
+        cparse_log_info("from the sink");
+    }
+
+    __atomic_add_fetch(count, 1, __ATOMIC_RELAXED);
+}
+
+START_TEST(test_cparse_log_reentrant_sink)
+{
+    static int count = 0;
+    cParseLogLevel level = cparse_current_log_level;
+
+    cparse_set_log_sink(cparse_test_log_logging_sink, &count);
+
+    cparse_set_log_level(cParseLogInfo);
+
+    cparse_enable_async_logging(true);
+
+    cparse_log_info("logs again");
+
+    cparse_log_cleanup();
+
+    cparse_set_log_sink(NULL, NULL);
+
+    cparse_set_log_level(level);
+
+    /* the message, and the one logged by the sink as the writer drained */
+    fail_unless(__atomic_load_n(&count, __ATOMIC_RELAXED) == 2);
+}
+END_TEST
+
+/* counts records for the toggle test, the parameter is the counter */
+static void cparse_test_log_toggle_sink(const cParseLogRecord *record, void *param)
+{
+    __atomic_add_fetch((int *)param, 1, __ATOMIC_RELAXED);
+}
+
+/* a sink for each thread of the toggle test */
+static int cparse_test_log_toggle_counts[CPARSE_TEST_LOG_THREADS];
+
+/* turns async logging on and off and swaps the sink while logging */
+static void *cparse_test_log_toggle(void *arg)
+{
+    int thread = *(int *)arg, i;
+
+    for (i = 0; i < CPARSE_TEST_LOG_MESSAGES; i++) {
+        cparse_enable_async_logging(i % 2 == 0);
+
+        cparse_set_log_sink(cparse_test_log_toggle_sink, &cparse_test_log_toggle_counts[thread]);
+
+        cparse_log_info("thread %d message %d", thread, i);
+    }
+
+    return NULL;
+}
+
+START_TEST(test_cparse_log_toggle)
+{
+    pthread_t threads[CPARSE_TEST_LOG_THREADS];
+    int ids[CPARSE_TEST_LOG_THREADS];
+    cParseLogLevel level = cparse_current_log_level;
+    int i;
+
+    cparse_set_log_level(cParseLogInfo);
+
+    for (i = 0; i < CPARSE_TEST_LOG_THREADS; i++) {
+        ids[i] = i;
+
+        fail_unless(pthread_create(&threads[i], NULL, cparse_test_log_toggle, &ids[i]) == 0);
+    }
+
+    for (i = 0; i < CPARSE_TEST_LOG_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    cparse_log_cleanup();
+
+    cparse_set_log_sink(NULL, NULL);
+
+    cparse_set_log_level(level);
+
+    /* every message is written once, whichever sink it went to */
+    fail_unless(cparse_test_log_toggle_counts[0] + cparse_test_log_toggle_counts[1] ==
+                CPARSE_TEST_LOG_THREADS * CPARSE_TEST_LOG_MESSAGES);
+}
+END_TEST
+
+START_TEST(test_cparse_error_codes)
+{
+    cParseMemoryStats before, after;
+    cParseError *error = NULL;
+
+    cparse_memory_stats(&before);
+
+    /* known codes are shared and not allocated */
+    error = cparse_error_with_code(cParseErrorObjectNotFound);
+
+    fail_unless(cparse_error_code(error) == 101);
+
+    fail_unless(!strcmp(cparse_error_message(error), "object not found"));
+
+    fail_unless(cparse_error_with_code(cParseErrorObjectNotFound) == error);
+
+    cparse_error_set_code(error, 1);
+
+    fail_unless(cparse_error_code(error) == 101);
+
+    cparse_error_free(error);
+
+    error = cparse_error_with_code_and_message(cParseErrorHttpServiceUnavailable, "service unavailable");
+
+    fail_unless(cparse_error_code(error) == 503);
+
+    cparse_error_free(error);
+
+    cparse_memory_stats(&after);
+
+    fail_unless(after.allocations == before.allocations);
+
+    /* a different message is copied */
+    error = cparse_error_with_code_and_message(cParseErrorObjectNotFound, "no such score");
+
+    fail_unless(cparse_error_code(error) == 101);
+
+    fail_unless(!strcmp(cparse_error_message(error), "no such score"));
+
+    fail_unless(error != cparse_error_with_code(cParseErrorObjectNotFound));
+
+    cparse_error_free(error);
+
+    /* unknown codes have no message */
+    error = cparse_error_with_code(12345);
+
+    fail_unless(cparse_error_code(error) == 12345);
+
+    fail_unless(cparse_error_message(error) == NULL);
+
+    fail_unless(cparse_error_code_message(12345) == NULL);
+
+    cparse_error_free(error);
+}
+END_TEST
+
 Suite *cparse_parse_suite(void)
 {
     Suite *s = suite_create("Config");
@@ -154,6 +553,13 @@ Suite *cparse_parse_suite(void)
     /* Core test case */
     TCase *tc = tcase_create("Config");
     tcase_add_checked_fixture(tc, cparse_test_setup, cparse_test_teardown);
+    tcase_add_test(tc, test_cparse_log_sink);
+    tcase_add_test(tc, test_cparse_log_async);
+    tcase_add_test(tc, test_cparse_log_dropped);
+    tcase_add_test(tc, test_cparse_log_blocked_sink);
+    tcase_add_test(tc, test_cparse_log_reentrant_sink);
+    tcase_add_test(tc, test_cparse_log_toggle);
+    tcase_add_test(tc, test_cparse_error_codes);
     suite_add_tcase(s, tc);
 
     return s;
@@ -7,6 +7,8 @@
 #include <cparse/query.h>
 #include "parse.test.h"
 
+extern cParseObject *cparse_object_from_query(cParseQuery *query, cParseJson *data);
+
 static void cparse_test_setup()
 {
 }
@@ -96,6 +98,100 @@ START_TEST(test_cparse_query_where)
 }
 END_TEST
 
+START_TEST(test_cparse_query_lazy_results)
+{
+    cParseQuery *query;
+    cParseJson *where;
+    cParseObject *result;
+    cParseError *error = NULL;
+
+    fail_unless(cparse_create_and_save_test_object("user2", 1700));
+
+    query = cparse_query_with_class_name(TEST_CLASS);
+
+    cparse_query_set_lazy_results(query, true);
+
+    where = cparse_json_new();
+
+    cparse_json_set_string(where, "playerName", "user2");
+
+    cparse_query_set_where(query, where);
+
+    cparse_json_free(where);
+
+    fail_unless(cparse_query_find_objects(query, &error));
+
+    fail_unless(cparse_query_size(query) > 0);
+
+    result = cparse_query_result(query, 0);
+
+    fail_unless(result != NULL);
+
+    fail_unless(!strcmp(cparse_object_get_string(result, "playerName"), "user2"));
+
+    /* metadata access merges the result */
+    fail_unless(cparse_object_id(result) != NULL);
+
+    fail_unless(cparse_object_created_at(result) > 0);
+
+    fail_unless(!cparse_object_contains(result, "objectId"));
+
+    fail_unless(cparse_query_result(query, cparse_query_size(query)) == NULL);
+
+    cparse_query_free(query);
+}
+END_TEST
+
+START_TEST(test_cparse_query_lazy_metadata)
+{
+    cParseQuery *query;
+    cParseJson *row;
+    cParseObject *result;
+
+    query = cparse_query_with_class_name(TEST_CLASS);
+
+    cparse_query_set_lazy_results(query, true);
+
+    row = cparse_json_tokenize("{\"objectId\":\"lazy1\",\"createdAt\":\"2011-08-20T02:06:57.931Z\",\"score\":1}");
+
+    fail_unless(row != NULL);
+
+    result = cparse_object_from_query(query, row);
+
+    fail_unless(result != NULL);
+
+    /* the metadata is never an attribute, before or after the merge */
+    fail_unless(cparse_object_get(result, "objectId") == NULL);
+
+    fail_unless(cparse_object_get_string(result, "objectId") == NULL);
+
+    fail_unless(!cparse_object_contains(result, "createdAt"));
+
+    fail_unless(cparse_object_get_number(result, "score", 0) == 1);
+
+    fail_unless(!strcmp(cparse_object_id(result), "lazy1"));
+
+    fail_unless(cparse_object_get(result, "objectId") == NULL);
+
+    fail_unless(!cparse_object_contains(result, "createdAt"));
+
+    /* changes go to the object, not the response */
+    cparse_object_set_number(result, "score", 2);
+
+    fail_unless(cparse_object_get_number(result, "score", 0) == 2);
+
+    fail_unless(cparse_json_get_number(row, "score", 0) == 1);
+
+    fail_unless(!strcmp(cparse_json_get_string(row, "objectId"), "lazy1"));
+
+    cparse_object_free(result);
+
+    cparse_json_free(row);
+
+    cparse_query_free(query);
+}
+END_TEST
+
 Suite *cparse_query_suite(void)
 {
     Suite *s = suite_create("Query");
@@ -105,6 +201,8 @@ Suite *cparse_query_suite(void)
     tcase_add_checked_fixture(tc, cparse_test_setup, cparse_test_teardown);
     tcase_add_test(tc, test_cparse_query_objects);
     tcase_add_test(tc, test_cparse_query_where);
+    tcase_add_test(tc, test_cparse_query_lazy_results);
+    tcase_add_test(tc, test_cparse_query_lazy_metadata);
     tcase_set_timeout(tc, 30);
     suite_add_tcase(s, tc);
 
@@ -0,0 +1,143 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cparse/json.h>
+#include <cparse/types.h>
+#include <cparse/memory.h>
+#include "base64.h"
+
+/* large enough for the vector versions to be used */
+#define CPARSE_TEST_DATA_SIZE 4099
+
+START_TEST(test_cparse_base64_vectors)
+{
+    static const char *const vectors[][2] = {
+        {"", ""}, {"f", "Zg=="}, {"fo", "Zm8="}, {"foo", "Zm9v"}, {"foob", "Zm9vYg=="}, {"fooba", "Zm9vYmE="}, {"foobar", "Zm9vYmFy"}
+    };
+    char out[16];
+    size_t i, size = 0;
+
+    for (i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+        size_t length = strlen(vectors[i][0]);
+
+        fail_unless(cparse_base64_encoded_size(length) == strlen(vectors[i][1]));
+
+        fail_unless(cparse_base64_encode(out, vectors[i][0], length) == strlen(vectors[i][1]));
+
+        fail_unless(!memcmp(out, vectors[i][1], strlen(vectors[i][1])));
+
+        fail_unless(cparse_base64_decode(out, vectors[i][1], strlen(vectors[i][1]), &size));
+
+        fail_unless(size == length && !memcmp(out, vectors[i][0], length));
+    }
+
+    /* padding is optional */
+    fail_unless(cparse_base64_decode(out, "Zm8", 3, &size));
+
+    fail_unless(size == 2 && !memcmp(out, "fo", 2));
+}
+END_TEST
+
+START_TEST(test_cparse_base64_round_trip)
+{
+    unsigned char *data = malloc(CPARSE_TEST_DATA_SIZE);
+    unsigned char *decoded = malloc(cparse_base64_decoded_size(cparse_base64_encoded_size(CPARSE_TEST_DATA_SIZE)));
+    char *text = malloc(cparse_base64_encoded_size(CPARSE_TEST_DATA_SIZE));
+    size_t i, size, length;
+
+    for (i = 0; i < CPARSE_TEST_DATA_SIZE; i++) {
+        data[i] = (unsigned char)(i * 7 + (i >> 8));
+    }
+
+    /* every remainder and block boundary */
+    for (size = CPARSE_TEST_DATA_SIZE - 100; size <= CPARSE_TEST_DATA_SIZE; size++) {
+        size_t decodedSize = 0;
+
+        length = cparse_base64_encode(text, data, size);
+
+        fail_unless(length == cparse_base64_encoded_size(size));
+
+        fail_unless(cparse_base64_decode(decoded, text, length, &decodedSize));
+
+        fail_unless(decodedSize == size);
+
+        fail_unless(!memcmp(decoded, data, size));
+    }
+
+    free(data);
+    free(decoded);
+    free(text);
+}
+END_TEST
+
+START_TEST(test_cparse_base64_invalid)
+{
+    char *text = malloc(cparse_base64_encoded_size(CPARSE_TEST_DATA_SIZE));
+    unsigned char *decoded = malloc(CPARSE_TEST_DATA_SIZE);
+    size_t length = 0, size = 0;
+
+    memset(decoded, 0xAB, CPARSE_TEST_DATA_SIZE);
+
+    length = cparse_base64_encode(text, decoded, CPARSE_TEST_DATA_SIZE);
+
+    /* in a block the vector versions decode, and in the scalar tail */
+    text[100] = '*';
+
+    fail_unless(!cparse_base64_decode(decoded, text, length, &size));
+
+    text[100] = 'A';
+
+    text[length - 3] = '-';
+
+    fail_unless(!cparse_base64_decode(decoded, text, length, &size));
+
+    /* a single character can't be decoded */
+    fail_unless(!cparse_base64_decode(decoded, "QUJD" "Q", 5, &size));
+
+    free(text);
+    free(decoded);
+}
+END_TEST
+
+START_TEST(test_cparse_bytes_json)
+{
+    static const char data[] = "bytes\0with\0nuls";
+    cParseJson *json = cparse_bytes_from_data(data, sizeof(data));
+    cParseJson *other = cparse_json_new();
+    size_t size = 0;
+    char *decoded = NULL;
+
+    fail_unless(json != NULL);
+
+    fail_unless(cparse_json_is_bytes(json));
+
+    fail_unless(!cparse_json_is_file(json));
+
+    decoded = cparse_bytes_to_data(json, &size);
+
+    fail_unless(decoded != NULL);
+
+    fail_unless(size == sizeof(data) && !memcmp(decoded, data, size));
+
+    fail_unless(cparse_bytes_to_data(other, &size) == NULL);
+
+    cparse_free(decoded);
+    cparse_json_free(json);
+    cparse_json_free(other);
+}
+END_TEST
+
+Suite *cparse_types_suite(void)
+{
+    Suite *s = suite_create("Types");
+
+    TCase *tc = tcase_create("Types");
+    tcase_add_test(tc, test_cparse_base64_vectors);
+    tcase_add_test(tc, test_cparse_base64_round_trip);
+    tcase_add_test(tc, test_cparse_base64_invalid);
+    tcase_add_test(tc, test_cparse_bytes_json);
+    suite_add_tcase(s, tc);
+
+    return s;
+}
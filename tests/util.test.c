@@ -22,6 +22,37 @@ START_TEST(test_cparse_date_time)
 }
 END_TEST
 
+START_TEST(test_cparse_date_time_ms)
+{
+    fail_unless(cparse_date_time_ms("2011-08-20T02:06:57.931Z") == 1313806017931LL);
+
+    fail_unless(cparse_date_time_ms("2011-08-20T04:06:57.931+02:00") == 1313806017931LL);
+
+    fail_unless(cparse_date_time_ms("1969-12-31T23:59:59.500Z") == -500);
+
+    fail_unless(cparse_date_time("1969-12-31T23:59:59.500Z") == -1);
+
+    fail_unless(cparse_date_time_ms("2011-08-20") == 1313798400000LL);
+
+    fail_unless(cparse_date_time_ms("2011-13-20T02:06:57Z") == 0);
+
+    /* days past the end of the month */
+    fail_unless(cparse_date_time_ms("2011-02-31T02:06:57Z") == 0);
+
+    fail_unless(cparse_date_time_ms("2011-04-31") == 0);
+
+    fail_unless(cparse_date_time_ms("2011-02-29") == 0);
+
+    fail_unless(cparse_date_time_ms("1900-02-29") == 0);
+
+    fail_unless(cparse_date_time_ms("2012-02-29") == 1330473600000LL);
+
+    fail_unless(cparse_date_time_ms("2000-02-29") == 951782400000LL);
+
+    fail_unless(cparse_date_time_ms("not a date") == 0);
+}
+END_TEST
+
 Suite *cparse_util_suite (void)
 {
     Suite *s = suite_create ("Util");
@@ -30,6 +61,7 @@ Suite *cparse_util_suite (void)
     TCase *tc = tcase_create ("Util");
     tcase_add_checked_fixture(tc, cparse_test_setup, cparse_test_teardown);
     tcase_add_test(tc, test_cparse_date_time);
+    tcase_add_test(tc, test_cparse_date_time_ms);
     suite_add_tcase(s, tc);
 
     return s;